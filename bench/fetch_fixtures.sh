@@ -0,0 +1,16 @@
+#!/bin/sh
+# Downloads the reference WAV fixtures used by stt-bench into bench/fixtures.
+set -e
+
+DIR="$(dirname "$0")/fixtures"
+mkdir -p "$DIR"
+
+fetch() {
+    if [ ! -f "$DIR/$1" ]; then
+        echo "Downloading $1"
+        wget -q -O "$DIR/$1" "$2"
+    fi
+}
+
+# 16 kHz mono English speech from the Vosk examples
+fetch vosk-test.wav https://raw.githubusercontent.com/alphacep/vosk-api/v0.3.45/python/example/test.wav
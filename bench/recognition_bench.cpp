@@ -0,0 +1,475 @@
+// stt-bench: replays WAV fixtures through RecognitionWorker, the same
+// ring buffer -> VAD -> Vosk path the app uses, and prints one JSON object
+// per fixture and mode on stdout.
+//
+// Modes:
+//   fast      push audio as fast as the decoder drains it; reports the
+//             real-time factor and allocations per second of audio
+//   realtime  push 20 ms chunks paced like a microphone; additionally
+//             reports latencies, measured from the moment the last audio
+//             a result depends on was pushed to the moment it is emitted:
+//               first_partial_latency_ms      first non-empty partial
+//               endpoint_to_final_latency_ms  each endpointed utterance
+//               stop_to_final_ms              the flush after the last push,
+//                                             what stopRecording() waits out
+//             and the largest decode chunk and ring backlog the adaptive
+//             scheduler reached (max_chunk_ms, max_backlog_ms)
+//
+// --alternatives 0,3,10 repeats every run per N-best size; each object then
+// also carries "alternatives" and alternatives_bytes_per_utterance, the
+// size of the raw N-best JSON kept per transcript row. Comparing
+// real_time_factor and allocations across N gives the cost of the list.
+//
+// --profiles low-power,balanced,accurate loads the model once per
+// performance profile (ModelProfile) and repeats every run; the header and
+// each object carry "profile", so decode speed, latency and memory can be
+// compared per device before picking a default.
+//
+// Allocation counts cover every operator new in the process (Vosk
+// included) while a fixture is being replayed.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "audio_converter.h"
+#include "audio_file_reader.h"
+#include "audio_ring_buffer.h"
+#include "model_profile.h"
+#include "recognition_worker.h"
+#include "recognizer_pool.h"
+#include "vosk_api.h"
+
+namespace {
+
+std::atomic<long long> g_allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr int PUSH_CHUNK_SAMPLES = SAMPLE_RATE / 50; // 20 ms, like a capture callback
+constexpr int RING_CAPACITY = SAMPLE_RATE * 16;
+
+struct Fixture
+{
+    QString path;
+    std::vector<int16_t> samples;
+};
+
+struct Events
+{
+    std::mutex mutex;
+    std::vector<Clock::time_point> pushTimes; // per pushed chunk
+    double firstPartialMs = -1.0;
+    std::vector<double> finalLatenciesMs;
+    qint64 alternativesBytes = 0;
+
+    double latencySince(qint64 consumedSamples, Clock::time_point now)
+    {
+        if (consumedSamples <= 0 || pushTimes.empty()) {
+            return 0.0;
+        }
+        size_t chunk = std::min(static_cast<size_t>((consumedSamples - 1) / PUSH_CHUNK_SAMPLES),
+                                pushTimes.size() - 1);
+        return std::chrono::duration<double, std::milli>(now - pushTimes[chunk]).count();
+    }
+};
+
+bool loadFixture(const QString &path, Fixture &fixture, QString &error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    AudioFileReader reader;
+    if (!reader.open(&file)) {
+        error = reader.errorString();
+        return false;
+    }
+
+    const int chunkBytes = 64 * 1024;
+    AudioConverter converter;
+    if (!converter.configure(reader.sampleRate(), reader.channels(), reader.sampleFormat(),
+                             SAMPLE_RATE, chunkBytes)) {
+        error = "Unsupported audio format";
+        return false;
+    }
+
+    std::vector<char> buffer(chunkBytes);
+    std::vector<int16_t> converted(converter.maxOutputSamples(chunkBytes));
+    qint64 bytes;
+    while ((bytes = reader.read(buffer.data(), chunkBytes)) > 0) {
+        int count = converter.process(buffer.data(), static_cast<int>(bytes), converted.data());
+        fixture.samples.insert(fixture.samples.end(), converted.begin(), converted.begin() + count);
+    }
+
+    fixture.path = path;
+    return true;
+}
+
+long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+double mean(const std::vector<double> &values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    return sum / values.size();
+}
+
+QJsonObject replay(RecognitionWorker *worker, AudioRingBuffer &ring, const Fixture &fixture, bool paced,
+                   int alternatives)
+{
+    Events events;
+    events.pushTimes.reserve(fixture.samples.size() / PUSH_CHUNK_SAMPLES + 1);
+
+    // Direct connections run on the worker thread at the moment of emission
+    QMetaObject::Connection partialConnection = QObject::connect(
+        worker, &RecognitionWorker::partialResult, worker, [&](const QString &stable, const QString &tail) {
+            if (stable.isEmpty() && tail.isEmpty()) {
+                return;
+            }
+            const auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(events.mutex);
+            if (events.firstPartialMs < 0.0) {
+                events.firstPartialMs = events.latencySince(worker->consumedSamples(), now);
+            }
+        }, Qt::DirectConnection);
+    QMetaObject::Connection finalConnection = QObject::connect(
+        worker, &RecognitionWorker::finalResult, worker, [&](const TranscriptSegment &segment) {
+            const auto now = Clock::now();
+            std::lock_guard<std::mutex> lock(events.mutex);
+            events.finalLatenciesMs.push_back(events.latencySince(worker->consumedSamples(), now));
+            events.alternativesBytes += segment.alternatives.size();
+        }, Qt::DirectConnection);
+
+    QMetaObject::invokeMethod(worker, &RecognitionWorker::reset, Qt::BlockingQueuedConnection);
+    if (paced) {
+        QMetaObject::invokeMethod(worker, &RecognitionWorker::start, Qt::QueuedConnection);
+    }
+
+    const long long allocationsBefore = g_allocations.load();
+    const auto start = Clock::now();
+    const size_t total = fixture.samples.size();
+    int maxChunkSamples = 0;
+    qint64 maxBacklogSamples = 0;
+
+    for (size_t offset = 0, chunk = 0; offset < total; offset += PUSH_CHUNK_SAMPLES, ++chunk) {
+        const size_t count = std::min<size_t>(PUSH_CHUNK_SAMPLES, total - offset);
+
+        if (paced) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(20 * chunk));
+        } else if (ring.available() + count > ring.capacity()) {
+            QMetaObject::invokeMethod(worker, &RecognitionWorker::drain, Qt::BlockingQueuedConnection);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(events.mutex);
+            events.pushTimes.push_back(Clock::now());
+        }
+        ring.push(fixture.samples.data() + offset, count);
+
+        if (paced) {
+            worker->wake();
+            maxChunkSamples = std::max(maxChunkSamples, worker->chunkSamples());
+            maxBacklogSamples = std::max(maxBacklogSamples, worker->backlogSamples());
+        }
+    }
+
+    // The final flush is not an endpoint; keep it out of the latency figures
+    const auto stopTime = Clock::now();
+    QMetaObject::invokeMethod(worker, &RecognitionWorker::drain, Qt::BlockingQueuedConnection);
+    size_t endpointed;
+    {
+        std::lock_guard<std::mutex> lock(events.mutex);
+        endpointed = events.finalLatenciesMs.size();
+    }
+    QMetaObject::invokeMethod(worker, &RecognitionWorker::finish, Qt::BlockingQueuedConnection);
+    const double stopToFinalMs = std::chrono::duration<double, std::milli>(Clock::now() - stopTime).count();
+
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const long long allocations = g_allocations.load() - allocationsBefore;
+
+    QObject::disconnect(partialConnection);
+    QObject::disconnect(finalConnection);
+
+    const double audioSeconds = static_cast<double>(total) / SAMPLE_RATE;
+
+    QJsonObject obj;
+    obj.insert("fixture", QFileInfo(fixture.path).fileName());
+    obj.insert("mode", paced ? "realtime" : "fast");
+    obj.insert("audio_seconds", audioSeconds);
+    obj.insert("wall_seconds", wallSeconds);
+    obj.insert("allocations_per_audio_second", audioSeconds > 0.0 ? allocations / audioSeconds : 0.0);
+    obj.insert("peak_rss_kb", static_cast<qint64>(peakRssKb()));
+    if (alternatives > 0) {
+        const size_t utterances = events.finalLatenciesMs.size();
+        obj.insert("alternatives", alternatives);
+        obj.insert("alternatives_bytes_per_utterance",
+                   utterances > 0 ? static_cast<double>(events.alternativesBytes) / utterances : 0.0);
+    }
+
+    if (paced) {
+        std::vector<double> latencies(events.finalLatenciesMs.begin(),
+                                      events.finalLatenciesMs.begin() + endpointed);
+        obj.insert("first_partial_latency_ms", events.firstPartialMs);
+        obj.insert("endpoint_to_final_latency_ms", QJsonObject {
+            { "count", static_cast<int>(latencies.size()) },
+            { "mean", mean(latencies) },
+            { "p95", percentile(latencies, 0.95) },
+        });
+        obj.insert("stop_to_final_ms", stopToFinalMs);
+        obj.insert("max_chunk_ms", maxChunkSamples * 1000.0 / SAMPLE_RATE);
+        obj.insert("max_backlog_ms", maxBacklogSamples * 1000.0 / SAMPLE_RATE);
+    } else {
+        obj.insert("real_time_factor", audioSeconds > 0.0 ? wallSeconds / audioSeconds : 0.0);
+    }
+    return obj;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("stt-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Recognition benchmark: real-time factor, latency, memory and allocations.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("fixtures", "WAV files or directories of WAV files "
+                                             "(default: $STT_BENCH_FIXTURES or bench/fixtures).", "[fixtures...]");
+
+    QCommandLineOption modelOption({"m", "model"}, "Vosk model directory (default: $STT_MODEL).", "dir");
+    QCommandLineOption modeOption("mode", "fast, realtime or both (default: both).", "mode", "both");
+    QCommandLineOption noVadOption("no-vad", "Feed silence to the decoder as well.");
+    QCommandLineOption alternativesOption("alternatives", "Comma-separated N-best sizes to run (default: 0).",
+                                          "list", "0");
+    QCommandLineOption profilesOption("profiles", "Comma-separated performance profiles to run: "
+                                                  + ModelProfile::names().join(", ") + " (default: balanced).",
+                                      "list", "balanced");
+    parser.addOptions({ modelOption, modeOption, noVadOption, alternativesOption, profilesOption });
+    parser.process(app);
+
+    QString modelPath = parser.value(modelOption);
+    if (modelPath.isEmpty()) {
+        modelPath = qEnvironmentVariable("STT_MODEL");
+    }
+    if (modelPath.isEmpty()) {
+        fprintf(stderr, "stt-bench: no model given, use --model or set STT_MODEL\n");
+        return 2;
+    }
+
+    const QString mode = parser.value(modeOption);
+    const bool runFast = mode == "fast" || mode == "both";
+    const bool runRealtime = mode == "realtime" || mode == "both";
+    if (!runFast && !runRealtime) {
+        fprintf(stderr, "stt-bench: unknown mode %s\n", qPrintable(mode));
+        return 2;
+    }
+
+    std::vector<int> alternativeSizes;
+    for (const QString &value : parser.value(alternativesOption).split(',')) {
+        bool valid = false;
+        const int n = value.trimmed().toInt(&valid);
+        if (!valid || n < 0) {
+            fprintf(stderr, "stt-bench: bad alternatives size %s\n", qPrintable(value));
+            return 2;
+        }
+        alternativeSizes.push_back(n);
+    }
+
+    std::vector<ModelProfile::Profile> profiles;
+    for (const QString &value : parser.value(profilesOption).split(',')) {
+        ModelProfile::Profile profile;
+        if (!ModelProfile::fromName(value.trimmed(), &profile)) {
+            fprintf(stderr, "stt-bench: unknown profile %s\n", qPrintable(value));
+            return 2;
+        }
+        profiles.push_back(profile);
+    }
+
+    QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        QString dir = qEnvironmentVariable("STT_BENCH_FIXTURES");
+        inputs << (dir.isEmpty() ? QString("bench/fixtures") : dir);
+    }
+
+    QStringList paths;
+    for (const QString &input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            for (const QFileInfo &entry : QDir(input).entryInfoList({ "*.wav" }, QDir::Files, QDir::Name)) {
+                paths << entry.filePath();
+            }
+        } else {
+            paths << input;
+        }
+    }
+    if (paths.isEmpty()) {
+        fprintf(stderr, "stt-bench: no fixtures found (see bench/fetch_fixtures.sh)\n");
+        return 2;
+    }
+
+    vosk_set_log_level(-1);
+
+    // Profile directories are recreated as needed and removed on exit
+    QTemporaryDir profileDir;
+
+    AudioRingBuffer ring(RING_CAPACITY);
+    QThread decodeThread;
+    RecognitionWorker *worker = new RecognitionWorker(&ring);
+    worker->moveToThread(&decodeThread);
+    QObject::connect(&decodeThread, &QThread::finished, worker, &QObject::deleteLater);
+    decodeThread.start();
+
+    const bool vadEnabled = !parser.isSet(noVadOption);
+    QMetaObject::invokeMethod(worker, [&]() {
+        worker->setVadEnabled(vadEnabled);
+        // Measure the decoder, not the drop policy: fast mode queues far
+        // more than the default backlog budget on purpose
+        worker->setOverflowPolicy(RecognitionWorker::Block);
+    }, Qt::BlockingQueuedConnection);
+
+    int status = 0;
+    for (ModelProfile::Profile profile : profiles) {
+        const QString profileName = ModelProfile::name(profile);
+        QString error;
+        const QString profilePath = ModelProfile::prepare(modelPath, profile, profileDir.path(), &error);
+        if (profilePath.isEmpty()) {
+            fprintf(stderr, "stt-bench: %s\n", qPrintable(error));
+            status = 1;
+            continue;
+        }
+
+        auto loadStart = Clock::now();
+        std::shared_ptr<RecognizerPool> pool = RecognizerPool::create(
+            vosk_model_new(profilePath.toUtf8().constData()), static_cast<float>(SAMPLE_RATE));
+        if (!pool) {
+            fprintf(stderr, "stt-bench: failed to load model from %s\n", qPrintable(profilePath));
+            status = 1;
+            continue;
+        }
+        const double modelLoadSeconds = std::chrono::duration<double>(Clock::now() - loadStart).count();
+
+        bool ok = false;
+        const int hangoverMs = ModelProfile::vadHangoverMs(profilePath);
+        QMetaObject::invokeMethod(worker, [&]() {
+            worker->setVadHangoverMs(hangoverMs);
+            ok = worker->createRecognizer(pool);
+        }, Qt::BlockingQueuedConnection);
+        if (!ok) {
+            fprintf(stderr, "stt-bench: failed to create recognizer\n");
+            status = 1;
+            continue;
+        }
+
+        QJsonObject header;
+        header.insert("model", QFileInfo(modelPath).fileName());
+        header.insert("profile", profileName);
+        header.insert("vad_hangover_ms", hangoverMs);
+        header.insert("model_load_seconds", modelLoadSeconds);
+        header.insert("vad", vadEnabled);
+        header.insert("peak_rss_kb_after_load", static_cast<qint64>(peakRssKb()));
+        printf("%s\n", QJsonDocument(header).toJson(QJsonDocument::Compact).constData());
+
+        for (const QString &path : paths) {
+            Fixture fixture;
+            if (!loadFixture(path, fixture, error)) {
+                fprintf(stderr, "stt-bench: skipping %s: %s\n", qPrintable(path), qPrintable(error));
+                status = 1;
+                continue;
+            }
+
+            for (int alternatives : alternativeSizes) {
+                QMetaObject::invokeMethod(worker, [worker, alternatives]() {
+                    worker->setMaxAlternatives(alternatives);
+                }, Qt::BlockingQueuedConnection);
+
+                for (bool paced : { false, true }) {
+                    if (paced ? !runRealtime : !runFast) {
+                        continue;
+                    }
+                    QJsonObject result = replay(worker, ring, fixture, paced, alternatives);
+                    result.insert("profile", profileName);
+                    printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Compact).constData());
+                }
+                fflush(stdout);
+            }
+        }
+
+        // Free this profile's model before loading the next
+        QMetaObject::invokeMethod(worker, [worker]() {
+            worker->releaseRecognizer();
+        }, Qt::BlockingQueuedConnection);
+        pool.reset();
+    }
+
+    decodeThread.quit();
+    decodeThread.wait();
+
+    return status;
+}
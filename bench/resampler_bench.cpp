@@ -0,0 +1,99 @@
+// Measures the CPU cost of converting one second of device audio into the
+// 16 kHz mono int16 stream fed to Vosk, for the formats capture hardware
+// commonly falls back to. Prints one JSON object per case on stdout.
+
+#include "audio_converter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct BenchCase {
+    const char *name;
+    int rate;
+    int channels;
+    AudioConverter::SampleFormat format;
+};
+
+std::vector<char> synthesize(const BenchCase &c, int seconds)
+{
+    const int frames = c.rate * seconds;
+    const int bytesPerSample = c.format == AudioConverter::SampleFormat::Int16 ? 2 : 4;
+    std::vector<char> data(static_cast<size_t>(frames) * c.channels * bytesPerSample);
+
+    char *p = data.data();
+    for (int i = 0; i < frames; ++i) {
+        // Speech-band tone plus a little noise
+        float value = 0.4f * std::sin(2.0f * float(M_PI) * 440.0f * i / c.rate)
+                    + 0.01f * static_cast<float>((i * 7919) % 200 - 100) / 100.0f;
+        for (int ch = 0; ch < c.channels; ++ch) {
+            if (c.format == AudioConverter::SampleFormat::Int16) {
+                int16_t s = static_cast<int16_t>(value * 32767.0f);
+                std::memcpy(p, &s, sizeof(s));
+            } else {
+                std::memcpy(p, &value, sizeof(value));
+            }
+            p += bytesPerSample;
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 60;
+    if (seconds <= 0) {
+        seconds = 60;
+    }
+
+    const BenchCase cases[] = {
+        { "48000-stereo-s16", 48000, 2, AudioConverter::SampleFormat::Int16 },
+        { "48000-stereo-f32", 48000, 2, AudioConverter::SampleFormat::Float32 },
+        { "44100-stereo-s16", 44100, 2, AudioConverter::SampleFormat::Int16 },
+        { "44100-mono-s16", 44100, 1, AudioConverter::SampleFormat::Int16 },
+        { "8000-mono-s16", 8000, 1, AudioConverter::SampleFormat::Int16 },
+    };
+
+    for (const BenchCase &c : cases) {
+        std::vector<char> input = synthesize(c, seconds);
+
+        // Same chunking as the capture path: ~20 ms reads
+        const int chunkBytes = c.rate / 50 * c.channels
+            * (c.format == AudioConverter::SampleFormat::Int16 ? 2 : 4);
+
+        AudioConverter converter;
+        converter.configure(c.rate, c.channels, c.format, 16000, chunkBytes);
+        std::vector<int16_t> output(converter.maxOutputSamples(chunkBytes));
+
+        long long produced = 0;
+        std::clock_t cpuStart = std::clock();
+        auto wallStart = std::chrono::steady_clock::now();
+
+        for (size_t offset = 0; offset < input.size(); offset += chunkBytes) {
+            int bytes = static_cast<int>(std::min<size_t>(chunkBytes, input.size() - offset));
+            produced += converter.process(input.data() + offset, bytes, output.data());
+        }
+
+        double cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        double wallSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - wallStart).count();
+
+        std::printf("{\"case\":\"%s\",\"audio_seconds\":%d,\"output_samples\":%lld,"
+                    "\"cpu_us_per_audio_second\":%.1f,\"wall_us_per_audio_second\":%.1f,"
+                    "\"realtime_factor\":%.5f}\n",
+                    c.name, seconds, produced,
+                    cpuSeconds * 1e6 / seconds, wallSeconds * 1e6 / seconds,
+                    wallSeconds / seconds);
+    }
+
+    return 0;
+}
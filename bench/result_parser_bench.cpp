@@ -0,0 +1,147 @@
+// Compares extracting the text from Vosk result JSON with QJsonDocument
+// (the previous approach) against VoskResult, counting heap allocations
+// and time per parse. Prints one JSON object per case on stdout.
+
+#include "vosk_result.h"
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<long long> g_allocations{0};
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Shaped like vosk_recognizer_partial_result() / result() output
+const char PARTIAL_JSON[] = "{\n  \"partial\" : \"one zero zero zero one nah no to i know\"\n}";
+
+const char RESULT_JSON[] =
+    "{\n"
+    "  \"result\" : [{\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 1.110000,\n      \"start\" : 0.870000,\n      \"word\" : \"what\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 1.530000,\n      \"start\" : 1.110000,\n      \"word\" : \"zero\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 1.950000,\n      \"start\" : 1.530000,\n      \"word\" : \"zero\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 2.340000,\n      \"start\" : 1.950000,\n      \"word\" : \"zero\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 2.610000,\n      \"start\" : 2.340000,\n      \"word\" : \"one\"\n"
+    "    }, {\n"
+    "      \"conf\" : 0.962106,\n      \"end\" : 3.000000,\n      \"start\" : 2.610000,\n      \"word\" : \"nine\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 3.300000,\n      \"start\" : 3.000000,\n      \"word\" : \"oh\"\n"
+    "    }, {\n"
+    "      \"conf\" : 1.000000,\n      \"end\" : 3.660000,\n      \"start\" : 3.300000,\n      \"word\" : \"two\"\n"
+    "    }],\n"
+    "  \"text\" : \"what zero zero zero one nine oh two\"\n"
+    "}";
+
+struct Measurement
+{
+    double nsPerParse = 0.0;
+    double allocationsPerParse = 0.0;
+    int textLength = 0;
+};
+
+template<typename Parse>
+Measurement measure(int iterations, Parse parse)
+{
+    // Warm up so reusable buffers reach their steady-state capacity
+    for (int i = 0; i < 16; ++i) {
+        parse();
+    }
+
+    Measurement m;
+    const long long allocationsBefore = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        m.textLength += parse();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    m.nsPerParse = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    m.allocationsPerParse = static_cast<double>(g_allocations.load() - allocationsBefore) / iterations;
+    return m;
+}
+
+void report(const char *name, const char *parser, const Measurement &m)
+{
+    printf("{\"case\":\"%s\",\"parser\":\"%s\",\"ns_per_parse\":%.1f,\"allocations_per_parse\":%.2f}\n",
+           name, parser, m.nsPerParse, m.allocationsPerParse);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+    if (iterations <= 0) {
+        iterations = 200000;
+    }
+
+    struct BenchCase {
+        const char *name;
+        const char *json;
+        const char *key;
+    };
+    const BenchCase cases[] = {
+        { "partial", PARTIAL_JSON, "partial" },
+        { "result", RESULT_JSON, "text" },
+    };
+
+    VoskResult result;
+    for (const BenchCase &c : cases) {
+        const QString key = QString::fromLatin1(c.key);
+
+        // What the worker used to do for every chunk
+        report(c.name, "qjsondocument", measure(iterations, [&]() {
+            QJsonDocument doc = QJsonDocument::fromJson(QByteArray(c.json));
+            QString text = doc.object().value(key).toString().trimmed();
+            return text.size();
+        }));
+
+        // Parse only; a QString is built just when a result is emitted
+        report(c.name, "voskresult", measure(iterations, [&]() {
+            result.parse(c.json);
+            return result.textLength();
+        }));
+
+        report(c.name, "voskresult+qstring", measure(iterations, [&]() {
+            result.parse(c.json);
+            return result.textString().size();
+        }));
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// stt-cli: headless transcriber built on the same recognition core as the
+// QML plugin. Reads WAV or raw PCM files (or stdin), writes one JSON object
+// per input on stdout and timing statistics on stderr.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "file_transcriber.h"
+#include "recognizer_pool.h"
+#include "vosk_api.h"
+
+namespace {
+
+constexpr float SAMPLE_RATE = 16000.0f;
+
+QJsonObject toJson(const FileTranscription &result)
+{
+    QJsonObject obj;
+    obj.insert("file", result.path);
+    obj.insert("ok", result.ok);
+    if (!result.ok) {
+        obj.insert("error", result.error);
+        return obj;
+    }
+    obj.insert("text", result.text);
+    obj.insert("utterances", QJsonArray::fromStringList(result.utterances));
+    obj.insert("audio_seconds", result.audioSeconds);
+    obj.insert("processing_seconds", result.processingSeconds);
+    obj.insert("real_time_factor", result.realTimeFactor);
+    return obj;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("stt-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Transcribe audio files with Vosk, without a GUI or microphone.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "WAV or raw PCM files; '-' or nothing reads stdin.", "[files...]");
+
+    QCommandLineOption modelOption({"m", "model"}, "Vosk model directory (default: $STT_MODEL).", "dir");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Files decoded concurrently (default: CPU count).", "n");
+    QCommandLineOption rateOption("rate", "Sample rate of raw input (default: 16000).", "hz", "16000");
+    QCommandLineOption channelsOption("channels", "Channel count of raw input (default: 1).", "n", "1");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Show Vosk/Kaldi log output.");
+    parser.addOptions({ modelOption, jobsOption, rateOption, channelsOption, verboseOption });
+    parser.process(app);
+
+    QString modelPath = parser.value(modelOption);
+    if (modelPath.isEmpty()) {
+        modelPath = qEnvironmentVariable("STT_MODEL");
+    }
+    if (modelPath.isEmpty()) {
+        fprintf(stderr, "stt-cli: no model given, use --model or set STT_MODEL\n");
+        return 2;
+    }
+
+    QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        inputs << "-";
+    }
+    if (inputs.count("-") > 1) {
+        fprintf(stderr, "stt-cli: stdin can only be read once\n");
+        return 2;
+    }
+
+    const int rawRate = parser.value(rateOption).toInt();
+    const int rawChannels = parser.value(channelsOption).toInt();
+    if (rawRate <= 0 || rawChannels <= 0) {
+        fprintf(stderr, "stt-cli: invalid raw input format\n");
+        return 2;
+    }
+
+    int jobs = parser.isSet(jobsOption) ? parser.value(jobsOption).toInt() : QThread::idealThreadCount();
+    jobs = qBound(1, jobs, static_cast<int>(inputs.size()));
+
+    vosk_set_log_level(parser.isSet(verboseOption) ? 0 : -1);
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    std::shared_ptr<RecognizerPool> pool = RecognizerPool::create(
+        vosk_model_new(modelPath.toUtf8().constData()), SAMPLE_RATE, jobs);
+    if (!pool) {
+        fprintf(stderr, "stt-cli: failed to load model from %s\n", qPrintable(modelPath));
+        return 1;
+    }
+    const double modelLoadSeconds = wallTimer.nsecsElapsed() / 1e9;
+
+    // Workers pull inputs off a shared index; each holds one pooled session
+    std::atomic<int> nextInput{0};
+    std::mutex outputMutex;
+    QTextStream out(stdout);
+    std::vector<FileTranscription> results(inputs.size());
+
+    auto worker = [&]() {
+        FileTranscriber transcriber(pool->acquire());
+        transcriber.setRawFormat(rawRate, rawChannels, AudioConverter::SampleFormat::Int16);
+
+        for (int i = nextInput++; i < inputs.size(); i = nextInput++) {
+            FileTranscription result;
+            if (inputs[i] == "-") {
+                QFile in;
+                in.open(stdin, QIODevice::ReadOnly);
+                result = transcriber.transcribe(&in, "-");
+            } else {
+                result = transcriber.transcribe(inputs[i]);
+            }
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            out << QJsonDocument(toJson(result)).toJson(QJsonDocument::Compact) << '\n';
+            out.flush();
+            results[i] = result;
+        }
+    };
+
+    const double decodeStart = wallTimer.nsecsElapsed() / 1e9;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < jobs; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const double decodeSeconds = wallTimer.nsecsElapsed() / 1e9 - decodeStart;
+
+    pool.reset();
+
+    int failed = 0;
+    double audioSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    for (const FileTranscription &result : results) {
+        if (!result.ok) {
+            failed++;
+            continue;
+        }
+        audioSeconds += result.audioSeconds;
+        cpuSeconds += result.processingSeconds;
+    }
+
+    fprintf(stderr,
+            "model load:       %.3f s\n"
+            "files:            %d (%d failed), %d job(s)\n"
+            "audio:            %.2f s\n"
+            "decode wall time: %.3f s\n"
+            "throughput:       %.2fx real time\n"
+            "mean RTF:         %.4f per stream\n",
+            modelLoadSeconds,
+            static_cast<int>(inputs.size()), failed, jobs,
+            audioSeconds,
+            decodeSeconds,
+            decodeSeconds > 0.0 ? audioSeconds / decodeSeconds : 0.0,
+            audioSeconds > 0.0 ? cpuSeconds / audioSeconds : 0.0);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+#ifndef ALIGNEDBUFFER_H
+#define ALIGNEDBUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed-size, zero-initialized array of trivial elements starting on a
+// cache line. Audio buffers on the capture and decode paths are sized once
+// during setup and then reused for every frame, so there is no push_back
+// or capacity management; resize() reallocates and is not for hot paths.
+// The alignment keeps SIMD loads from splitting lines and stops adjacent
+// buffers owned by different threads from sharing one.
+template<typename T>
+class AlignedBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer holds plain samples");
+
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t size) { resize(size); }
+    ~AlignedBuffer() { release(); }
+
+    AlignedBuffer(const AlignedBuffer &) = delete;
+    AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+    AlignedBuffer(AlignedBuffer &&other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    AlignedBuffer &operator=(AlignedBuffer &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    // Discards the contents; the new elements are zero
+    void resize(size_t size)
+    {
+        if (size == m_size) {
+            fill(T());
+            return;
+        }
+        release();
+        if (size > 0) {
+            m_data = static_cast<T *>(::operator new(size * sizeof(T), std::align_val_t(ALIGNMENT)));
+            m_size = size;
+            std::memset(m_data, 0, size * sizeof(T));
+        }
+    }
+
+    void fill(const T &value)
+    {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_data[i] = value;
+        }
+    }
+
+    T *data() { return m_data; }
+    const T *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T &operator[](size_t i) { return m_data[i]; }
+    const T &operator[](size_t i) const { return m_data[i]; }
+
+    T *begin() { return m_data; }
+    T *end() { return m_data + m_size; }
+    const T *begin() const { return m_data; }
+    const T *end() const { return m_data + m_size; }
+
+private:
+    void release()
+    {
+        if (m_data) {
+            ::operator delete(m_data, std::align_val_t(ALIGNMENT));
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    T *m_data = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // ALIGNEDBUFFER_H
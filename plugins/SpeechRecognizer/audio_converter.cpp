@@ -0,0 +1,232 @@
+#include "audio_converter.h"
+#include "simd_dot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Zero crossings of the sinc kernel on each side; 8 keeps aliasing well
+// below what the acoustic model can hear while staying cheap per sample
+constexpr int KERNEL_ZERO_CROSSINGS = 8;
+// Cutoff relative to the lower Nyquist frequency, leaves room for roll-off
+constexpr double CUTOFF_RATIO = 0.9;
+constexpr int SIMD_WIDTH = 4;
+
+template <typename T>
+inline T readSample(const char *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+inline int16_t toInt16(float value)
+{
+    long scaled = std::lrint(value * 32768.0f);
+    return static_cast<int16_t>(std::clamp(scaled, -32768L, 32767L));
+}
+
+} // namespace
+
+bool AudioConverter::configure(int inputRate, int channels, SampleFormat format,
+                               int outputRate, int maxChunkBytes)
+{
+    if (inputRate <= 0 || channels <= 0 || outputRate <= 0) {
+        return false;
+    }
+
+    m_inputRate = inputRate;
+    m_outputRate = outputRate;
+    m_channels = channels;
+    m_format = format;
+
+    switch (format) {
+    case SampleFormat::UInt8:   m_bytesPerSample = 1; break;
+    case SampleFormat::Int16:   m_bytesPerSample = 2; break;
+    case SampleFormat::Int32:
+    case SampleFormat::Float32: m_bytesPerSample = 4; break;
+    }
+    m_frameBytes = m_bytesPerSample * channels;
+    m_passthrough = format == SampleFormat::Int16 && channels == 1 && inputRate == outputRate;
+
+    int divisor = std::gcd(inputRate, outputRate);
+    m_up = outputRate / divisor;
+    m_down = inputRate / divisor;
+
+    buildFilters();
+
+    m_pending.resize(m_frameBytes);
+    int maxFrames = maxChunkBytes / m_frameBytes + 1;
+    m_history.resize(m_taps - 1 + maxFrames);
+
+    reset();
+    return true;
+}
+
+void AudioConverter::reset()
+{
+    m_pendingBytes = 0;
+    m_time = 0;
+    m_history.fill(0.0f);
+}
+
+void AudioConverter::buildFilters()
+{
+    if (m_up == 1 && m_down == 1) {
+        // Same rate: no filtering, history is just the mono scratch buffer
+        m_taps = 1;
+        m_filters.resize(1);
+        m_filters[0] = 1.0f;
+        return;
+    }
+
+    // Prototype low-pass at the upsampled rate, cut below the lower Nyquist
+    const int factor = std::max(m_up, m_down);
+    const int halfWidth = KERNEL_ZERO_CROSSINGS * factor;
+    const int length = 2 * halfWidth + 1;
+    const double cutoff = 0.5 * CUTOFF_RATIO / factor;
+
+    std::vector<double> prototype(length);
+    for (int j = 0; j < length; ++j) {
+        double x = j - halfWidth;
+        double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * std::cos(2.0 * M_PI * j / (length - 1))
+                      + 0.08 * std::cos(4.0 * M_PI * j / (length - 1));
+        // Gain of m_up compensates for the zeros inserted when upsampling
+        prototype[j] = sinc * window * m_up;
+    }
+
+    // Split into m_up phases, each padded to the SIMD width and stored
+    // time-reversed so the inner loop is a straight dot product
+    int taps = (length + m_up - 1) / m_up;
+    m_taps = (taps + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    m_filters.resize(static_cast<size_t>(m_up) * m_taps);
+
+    for (int phase = 0; phase < m_up; ++phase) {
+        float *filter = m_filters.data() + static_cast<size_t>(phase) * m_taps;
+        for (int k = 0; k < m_taps; ++k) {
+            int j = phase + k * m_up;
+            filter[m_taps - 1 - k] = j < length ? static_cast<float>(prototype[j]) : 0.0f;
+        }
+    }
+}
+
+int AudioConverter::maxOutputSamples(int bytes) const
+{
+    // Upper bound regardless of how many bytes are pending from earlier calls
+    long long frames = bytes / m_frameBytes + 1;
+    return static_cast<int>((frames * m_up + m_down - 1) / m_down) + 1;
+}
+
+int AudioConverter::process(const char *data, int bytes, int16_t *out)
+{
+    if (m_frameBytes <= 0 || bytes <= 0) {
+        return 0;
+    }
+
+    const int totalFrames = (m_pendingBytes + bytes) / m_frameBytes;
+    const size_t needed = static_cast<size_t>(m_taps - 1 + totalFrames);
+    if (m_history.size() < needed) {
+        // Only happens when a chunk is larger than configure() planned for;
+        // the filter context carries over
+        AlignedBuffer<float> history(needed);
+        std::memcpy(history.data(), m_history.data(), (m_taps - 1) * sizeof(float));
+        m_history = std::move(history);
+    }
+
+    float *mono = m_history.data() + (m_taps - 1);
+    int frames = 0;
+
+    // Complete a frame split across the previous call
+    if (m_pendingBytes > 0) {
+        int take = std::min(bytes, m_frameBytes - m_pendingBytes);
+        std::memcpy(m_pending.data() + m_pendingBytes, data, take);
+        m_pendingBytes += take;
+        data += take;
+        bytes -= take;
+
+        if (m_pendingBytes < m_frameBytes) {
+            return 0;
+        }
+        frames += toMono(m_pending.data(), 1, mono);
+        m_pendingBytes = 0;
+    }
+
+    int whole = bytes / m_frameBytes;
+    frames += toMono(data, whole, mono + frames);
+
+    m_pendingBytes = bytes - whole * m_frameBytes;
+    std::memcpy(m_pending.data(), data + whole * m_frameBytes, m_pendingBytes);
+
+    if (frames == 0) {
+        return 0;
+    }
+
+    if (m_up == 1 && m_down == 1) {
+        for (int i = 0; i < frames; ++i) {
+            out[i] = toInt16(mono[i]);
+        }
+        return frames;
+    }
+
+    return resample(frames, out);
+}
+
+int AudioConverter::toMono(const char *data, int frames, float *out) const
+{
+    const float channelScale = 1.0f / m_channels;
+
+    for (int f = 0; f < frames; ++f) {
+        const char *frame = data + static_cast<size_t>(f) * m_frameBytes;
+        float sum = 0.0f;
+
+        for (int c = 0; c < m_channels; ++c) {
+            const char *p = frame + c * m_bytesPerSample;
+            switch (m_format) {
+            case SampleFormat::Int16:
+                sum += readSample<int16_t>(p) * (1.0f / 32768.0f);
+                break;
+            case SampleFormat::Int32:
+                sum += static_cast<float>(readSample<int32_t>(p) * (1.0 / 2147483648.0));
+                break;
+            case SampleFormat::UInt8:
+                sum += (static_cast<uint8_t>(*p) - 128) * (1.0f / 128.0f);
+                break;
+            case SampleFormat::Float32:
+                sum += readSample<float>(p);
+                break;
+            }
+        }
+        out[f] = sum * channelScale;
+    }
+    return frames;
+}
+
+int AudioConverter::resample(int inputCount, int16_t *out)
+{
+    // m_history holds m_taps - 1 samples of context followed by the new
+    // input, so input sample i is at m_history[i + m_taps - 1] and the
+    // window for it starts at m_history[i]
+    const float *history = m_history.data();
+    const long long limit = static_cast<long long>(inputCount) * m_up;
+    int produced = 0;
+
+    while (m_time < limit) {
+        const long long index = m_time / m_up;
+        const int phase = static_cast<int>(m_time % m_up);
+        const float *filter = m_filters.data() + static_cast<size_t>(phase) * m_taps;
+
+        out[produced++] = toInt16(simdDot(filter, history + index, m_taps));
+        m_time += m_down;
+    }
+    m_time -= limit;
+
+    // Keep the tail as context for the next call
+    std::memmove(m_history.data(), m_history.data() + inputCount, (m_taps - 1) * sizeof(float));
+
+    return produced;
+}
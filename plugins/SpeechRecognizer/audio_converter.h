@@ -0,0 +1,68 @@
+#ifndef AUDIOCONVERTER_H
+#define AUDIOCONVERTER_H
+
+#include <cstdint>
+
+#include "aligned_buffer.h"
+
+// Converts whatever the capture device delivers into the 16 kHz mono int16
+// stream Vosk expects: sample format conversion, channel downmix and a
+// polyphase windowed-sinc resampler whose inner loop is SIMD (simd_dot.h).
+// Input is little-endian interleaved PCM; partial frames are carried over
+// between calls, and scratch buffers are sized up front so steady-state
+// conversion does not allocate.
+class AudioConverter
+{
+public:
+    enum class SampleFormat {
+        Int16,
+        Int32,
+        UInt8,
+        Float32
+    };
+
+    AudioConverter() = default;
+
+    bool configure(int inputRate, int channels, SampleFormat format,
+                   int outputRate = 16000, int maxChunkBytes = 65536);
+    void reset();
+
+    // True when the input already is mono int16 at the output rate
+    bool isPassthrough() const { return m_passthrough; }
+
+    int inputRate() const { return m_inputRate; }
+    int outputRate() const { return m_outputRate; }
+    int channels() const { return m_channels; }
+
+    // Converts |bytes| of raw input into |out| and returns the number of
+    // output samples written. |out| must hold maxOutputSamples(bytes).
+    int process(const char *data, int bytes, int16_t *out);
+    int maxOutputSamples(int bytes) const;
+
+private:
+    int toMono(const char *data, int frames, float *out) const;
+    int resample(int inputCount, int16_t *out);
+    void buildFilters();
+
+    int m_inputRate = 0;
+    int m_outputRate = 0;
+    int m_channels = 0;
+    SampleFormat m_format = SampleFormat::Int16;
+    int m_bytesPerSample = 2;
+    int m_frameBytes = 2;
+    bool m_passthrough = false;
+
+    // Bytes of an incomplete input frame from the previous call
+    AlignedBuffer<char> m_pending;
+    int m_pendingBytes = 0;
+
+    // Polyphase resampler state: upsample by L, downsample by M
+    int m_up = 1;
+    int m_down = 1;
+    int m_taps = 0;       // taps per phase, padded to a multiple of 4
+    AlignedBuffer<float> m_filters; // m_up phases of m_taps, time-reversed
+    AlignedBuffer<float> m_history; // m_taps - 1 previous samples + current input
+    long long m_time = 0;         // next output position in upsampled units
+};
+
+#endif // AUDIOCONVERTER_H
@@ -0,0 +1,157 @@
+#include "audio_file_reader.h"
+
+#include <QByteArray>
+#include <QtEndian>
+
+namespace {
+
+constexpr quint16 WAVE_FORMAT_PCM = 0x0001;
+constexpr quint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr quint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+} // namespace
+
+void AudioFileReader::setRawFormat(int sampleRate, int channels, AudioConverter::SampleFormat format)
+{
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_format = format;
+}
+
+bool AudioFileReader::open(QIODevice *device)
+{
+    m_device = device;
+    m_error.clear();
+    m_isWav = false;
+    m_dataBytes = -1;
+    m_bytesRead = 0;
+
+    if (!m_device || !m_device->isReadable()) {
+        m_error = "Audio input is not readable";
+        return false;
+    }
+
+    if (m_device->peek(4) == "RIFF") {
+        m_isWav = true;
+        return parseWav();
+    }
+
+    // Raw PCM; the size is known only for regular files
+    if (!m_device->isSequential()) {
+        m_dataBytes = m_device->size() - m_device->pos();
+    }
+    return true;
+}
+
+bool AudioFileReader::parseWav()
+{
+    char riff[12];
+    if (!readExact(riff, sizeof(riff)) || qstrncmp(riff + 8, "WAVE", 4) != 0) {
+        m_error = "Not a WAVE file";
+        return false;
+    }
+
+    bool haveFormat = false;
+
+    for (;;) {
+        char header[8];
+        if (!readExact(header, sizeof(header))) {
+            m_error = "WAVE file has no data chunk";
+            return false;
+        }
+
+        const quint32 size = qFromLittleEndian<quint32>(header + 4);
+
+        if (qstrncmp(header, "fmt ", 4) == 0) {
+            char fmt[40] = {};
+            const qint64 wanted = qMin<qint64>(size, sizeof(fmt));
+            if (size < 16 || !readExact(fmt, wanted) || !skip(size - wanted + (size & 1))) {
+                m_error = "Malformed WAVE format chunk";
+                return false;
+            }
+
+            quint16 tag = qFromLittleEndian<quint16>(fmt);
+            m_channels = qFromLittleEndian<quint16>(fmt + 2);
+            m_sampleRate = static_cast<int>(qFromLittleEndian<quint32>(fmt + 4));
+            const quint16 bits = qFromLittleEndian<quint16>(fmt + 14);
+
+            // The real format tag of WAVE_FORMAT_EXTENSIBLE is the start of the sub-format GUID
+            if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 26) {
+                tag = qFromLittleEndian<quint16>(fmt + 24);
+            }
+
+            if (tag == WAVE_FORMAT_PCM && bits == 16) {
+                m_format = AudioConverter::SampleFormat::Int16;
+            } else if (tag == WAVE_FORMAT_PCM && bits == 32) {
+                m_format = AudioConverter::SampleFormat::Int32;
+            } else if (tag == WAVE_FORMAT_PCM && bits == 8) {
+                m_format = AudioConverter::SampleFormat::UInt8;
+            } else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+                m_format = AudioConverter::SampleFormat::Float32;
+            } else {
+                m_error = QString("Unsupported WAVE encoding (format %1, %2 bits)").arg(tag).arg(bits);
+                return false;
+            }
+            haveFormat = true;
+        } else if (qstrncmp(header, "data", 4) == 0) {
+            if (!haveFormat) {
+                m_error = "WAVE data chunk precedes format chunk";
+                return false;
+            }
+            // Streaming writers leave the size as 0 or 0xFFFFFFFF
+            m_dataBytes = (size == 0 || size == 0xFFFFFFFFu) ? -1 : static_cast<qint64>(size);
+            return true;
+        } else if (!skip(size + (size & 1))) {
+            m_error = "Truncated WAVE file";
+            return false;
+        }
+    }
+}
+
+qint64 AudioFileReader::read(char *data, qint64 maxBytes)
+{
+    if (!m_device) {
+        return -1;
+    }
+
+    if (m_dataBytes >= 0) {
+        maxBytes = qMin(maxBytes, m_dataBytes - m_bytesRead);
+        if (maxBytes <= 0) {
+            return 0;
+        }
+    }
+
+    qint64 bytes = m_device->read(data, maxBytes);
+    if (bytes > 0) {
+        m_bytesRead += bytes;
+    }
+    return bytes;
+}
+
+bool AudioFileReader::readExact(char *data, qint64 bytes)
+{
+    qint64 done = 0;
+    while (done < bytes) {
+        qint64 n = m_device->read(data + done, bytes - done);
+        if (n <= 0 && !m_device->waitForReadyRead(-1)) {
+            return false;
+        }
+        if (n > 0) {
+            done += n;
+        }
+    }
+    return true;
+}
+
+bool AudioFileReader::skip(qint64 bytes)
+{
+    char scratch[4096];
+    while (bytes > 0) {
+        qint64 chunk = qMin<qint64>(bytes, sizeof(scratch));
+        if (!readExact(scratch, chunk)) {
+            return false;
+        }
+        bytes -= chunk;
+    }
+    return true;
+}
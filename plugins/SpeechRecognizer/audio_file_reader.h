@@ -0,0 +1,51 @@
+#ifndef AUDIOFILEREADER_H
+#define AUDIOFILEREADER_H
+
+#include <QIODevice>
+#include <QString>
+
+#include "audio_converter.h"
+
+// Reads PCM audio from a WAV file or a headerless raw stream. WAV headers
+// (PCM, IEEE float and WAVE_FORMAT_EXTENSIBLE) are parsed in place, so the
+// device may be sequential (e.g. stdin). Anything without a RIFF header is
+// treated as raw audio in the format given by setRawFormat().
+class AudioFileReader
+{
+public:
+    AudioFileReader() = default;
+
+    void setRawFormat(int sampleRate, int channels, AudioConverter::SampleFormat format);
+
+    bool open(QIODevice *device);
+    QString errorString() const { return m_error; }
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    AudioConverter::SampleFormat sampleFormat() const { return m_format; }
+    bool isWav() const { return m_isWav; }
+
+    // Size of the audio payload in bytes, or -1 when unknown (streamed input)
+    qint64 dataBytes() const { return m_dataBytes; }
+    qint64 bytesRead() const { return m_bytesRead; }
+
+    qint64 read(char *data, qint64 maxBytes);
+
+private:
+    bool parseWav();
+    bool readExact(char *data, qint64 bytes);
+    bool skip(qint64 bytes);
+
+    QIODevice *m_device = nullptr;
+    QString m_error;
+    bool m_isWav = false;
+
+    int m_sampleRate = 16000;
+    int m_channels = 1;
+    AudioConverter::SampleFormat m_format = AudioConverter::SampleFormat::Int16;
+
+    qint64 m_dataBytes = -1;
+    qint64 m_bytesRead = 0;
+};
+
+#endif // AUDIOFILEREADER_H
@@ -0,0 +1,77 @@
+#include "audio_ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_data.resize(size);
+    m_mask = size - 1;
+}
+
+size_t AudioRingBuffer::push(const int16_t *data, size_t count)
+{
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    const size_t space = m_data.size() - (head - tail);
+
+    const size_t toWrite = std::min(count, space);
+    if (toWrite < count) {
+        m_overrunSamples.fetch_add(count - toWrite, std::memory_order_relaxed);
+    }
+    if (toWrite == 0) {
+        return 0;
+    }
+
+    // Copy in at most two pieces around the wrap point
+    const size_t offset = head & m_mask;
+    const size_t first = std::min(toWrite, m_data.size() - offset);
+    std::memcpy(m_data.data() + offset, data, first * sizeof(int16_t));
+    std::memcpy(m_data.data(), data + first, (toWrite - first) * sizeof(int16_t));
+
+    m_head.store(head + toWrite, std::memory_order_release);
+    return toWrite;
+}
+
+size_t AudioRingBuffer::pop(int16_t *data, size_t maxCount)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+
+    const size_t toRead = std::min(maxCount, head - tail);
+    if (toRead == 0) {
+        return 0;
+    }
+
+    const size_t offset = tail & m_mask;
+    const size_t first = std::min(toRead, m_data.size() - offset);
+    std::memcpy(data, m_data.data() + offset, first * sizeof(int16_t));
+    std::memcpy(data + first, m_data.data(), (toRead - first) * sizeof(int16_t));
+
+    m_tail.store(tail + toRead, std::memory_order_release);
+    return toRead;
+}
+
+size_t AudioRingBuffer::skip(size_t maxCount)
+{
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+
+    const size_t toSkip = std::min(maxCount, head - tail);
+    m_tail.store(tail + toSkip, std::memory_order_release);
+    return toSkip;
+}
+
+void AudioRingBuffer::discard()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t AudioRingBuffer::available() const
+{
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+}
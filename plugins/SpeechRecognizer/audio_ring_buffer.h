@@ -0,0 +1,46 @@
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "aligned_buffer.h"
+
+// Fixed-capacity single-producer/single-consumer ring of 16-bit samples.
+// The capture callback pushes and the decode thread pops; neither side
+// locks or allocates once the ring has been constructed. When the consumer
+// falls behind, samples that do not fit are dropped and counted.
+class AudioRingBuffer
+{
+public:
+    // Capacity is rounded up to the next power of two
+    explicit AudioRingBuffer(size_t capacity);
+
+    // Producer side
+    size_t push(const int16_t *data, size_t count);
+    size_t space() const { return m_data.size() - available(); }
+
+    // Consumer side
+    size_t pop(int16_t *data, size_t maxCount);
+    size_t skip(size_t maxCount); // drops the oldest samples unread
+    void discard();
+
+    size_t available() const;
+    size_t capacity() const { return m_data.size(); }
+    // Samples pushed and popped since construction; positions in the stream
+    size_t written() const { return m_head.load(std::memory_order_acquire); }
+    size_t read() const { return m_tail.load(std::memory_order_acquire); }
+    uint64_t overrunSamples() const { return m_overrunSamples.load(std::memory_order_relaxed); }
+
+private:
+    AlignedBuffer<int16_t> m_data;
+    size_t m_mask = 0;
+
+    // Kept on separate cache lines so producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> m_head{0}; // written by producer
+    alignas(64) std::atomic<size_t> m_tail{0}; // written by consumer
+    alignas(64) std::atomic<uint64_t> m_overrunSamples{0};
+};
+
+#endif // AUDIORINGBUFFER_H
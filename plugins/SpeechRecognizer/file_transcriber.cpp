@@ -0,0 +1,150 @@
+#include "file_transcriber.h"
+#include "audio_file_reader.h"
+#include "vosk_api.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+
+FileTranscriber::FileTranscriber(RecognitionSession session)
+    : m_session(std::move(session))
+    , m_readBuffer(READ_CHUNK_BYTES)
+{
+}
+
+void FileTranscriber::setRawFormat(int sampleRate, int channels, AudioConverter::SampleFormat format)
+{
+    m_rawSampleRate = sampleRate;
+    m_rawChannels = channels;
+    m_rawFormat = format;
+}
+
+FileTranscription FileTranscriber::transcribe(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        FileTranscription result;
+        result.path = path;
+        result.error = "Cannot open " + path + ": " + file.errorString();
+        return result;
+    }
+    return transcribe(&file, path);
+}
+
+FileTranscription FileTranscriber::transcribe(QIODevice *device, const QString &name)
+{
+    FileTranscription result;
+    result.path = name;
+
+    VoskRecognizer *recognizer = m_session.recognizer();
+    if (!recognizer) {
+        result.error = "No recognizer available";
+        return result;
+    }
+
+    AudioFileReader reader;
+    reader.setRawFormat(m_rawSampleRate, m_rawChannels, m_rawFormat);
+    if (!reader.open(device)) {
+        result.error = reader.errorString();
+        return result;
+    }
+
+    if (!m_converter.configure(reader.sampleRate(), reader.channels(), reader.sampleFormat(),
+                               SAMPLE_RATE, READ_CHUNK_BYTES)) {
+        result.error = "Unsupported audio format in " + name;
+        return result;
+    }
+    m_samples.resize(m_converter.maxOutputSamples(READ_CHUNK_BYTES));
+
+    vosk_recognizer_reset(recognizer);
+    m_fedOrigin = m_session.fedSamples();
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 totalSamples = 0;
+    qint64 skipSamples = m_startMs * SAMPLE_RATE / 1000;
+
+    for (;;) {
+        if (m_cancel && m_cancel->load(std::memory_order_relaxed)) {
+            result.error = "Cancelled";
+            return result;
+        }
+
+        qint64 bytes = reader.read(m_readBuffer.data(), READ_CHUNK_BYTES);
+        if (bytes <= 0) {
+            break;
+        }
+
+        int count = m_converter.process(m_readBuffer.data(), static_cast<int>(bytes), m_samples.data());
+        totalSamples += count;
+
+        // Still reading past the skipped start; converting it is cheap
+        const int skip = static_cast<int>(std::min<qint64>(skipSamples, count));
+        skipSamples -= skip;
+        count -= skip;
+
+        if (count > 0 && m_session.acceptWaveform(m_samples.data() + skip, count)) {
+            handleResult(vosk_recognizer_result(recognizer), result);
+        }
+
+        if (m_onProgress && reader.dataBytes() > 0) {
+            m_onProgress(static_cast<double>(reader.bytesRead()) / reader.dataBytes());
+        }
+    }
+
+    handleResult(vosk_recognizer_final_result(recognizer), result);
+
+    result.ok = true;
+    result.text = result.utterances.join(' ');
+    result.audioSeconds = static_cast<double>(totalSamples) / SAMPLE_RATE;
+    result.processingSeconds = timer.nsecsElapsed() / 1e9;
+    result.realTimeFactor = result.audioSeconds > 0.0
+        ? result.processingSeconds / result.audioSeconds : 0.0;
+
+    if (m_onProgress) {
+        m_onProgress(1.0);
+    }
+    return result;
+}
+
+void FileTranscriber::handleResult(const char *json, FileTranscription &result)
+{
+    if (!m_result.parse(json) || m_result.isEmpty()) {
+        return;
+    }
+
+    const QString text = m_result.textString();
+    result.utterances.append(text);
+
+    TranscriptSegment segment;
+    segment.text = text;
+    const std::vector<VoskWord> &words = m_result.words();
+    if (!words.empty()) {
+        segment.words.reserve(static_cast<int>(words.size()));
+        float sum = 0.0f;
+        for (const VoskWord &word : words) {
+            TranscriptWord w;
+            w.text = QString::fromUtf8(word.text, word.length);
+            w.startMs = m_startMs + (qRound64(word.start * SAMPLE_RATE) - m_fedOrigin) * 1000 / SAMPLE_RATE;
+            w.endMs = m_startMs + (qRound64(word.end * SAMPLE_RATE) - m_fedOrigin) * 1000 / SAMPLE_RATE;
+            w.confidence = word.conf;
+            segment.words.append(w);
+            sum += word.conf;
+        }
+        segment.confidence = sum / words.size();
+        segment.startMs = segment.words.first().startMs;
+        segment.endMs = segment.words.last().endMs;
+    } else {
+        segment.startMs = result.segments.isEmpty() ? m_startMs : result.segments.last().endMs;
+        segment.endMs = m_startMs + (m_session.fedSamples() - m_fedOrigin) * 1000 / SAMPLE_RATE;
+    }
+    result.segments.append(segment);
+
+    if (m_onUtterance) {
+        m_onUtterance(text);
+    }
+    if (m_onSegment) {
+        m_onSegment(segment);
+    }
+}
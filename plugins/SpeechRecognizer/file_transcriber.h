@@ -0,0 +1,88 @@
+#ifndef FILETRANSCRIBER_H
+#define FILETRANSCRIBER_H
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+#include "aligned_buffer.h"
+#include "audio_converter.h"
+#include "recognizer_pool.h"
+#include "transcript_segment.h"
+#include "vosk_result.h"
+
+struct FileTranscription
+{
+    QString path;
+    QString text;
+    QStringList utterances;
+    QVector<TranscriptSegment> segments; // times are milliseconds into the file
+    QString error;
+    bool ok = false;
+    double audioSeconds = 0.0;
+    double processingSeconds = 0.0;
+    double realTimeFactor = 0.0;
+};
+
+// Streams a WAV or raw PCM file through a Vosk recognizer as fast as the
+// CPU allows (no real-time pacing). Runs entirely in the calling thread;
+// callers use one transcriber per thread to process files concurrently,
+// each with its own session from a shared RecognizerPool.
+class FileTranscriber
+{
+public:
+    using ProgressCallback = std::function<void(double progress)>;
+    using UtteranceCallback = std::function<void(const QString &text)>;
+    using SegmentCallback = std::function<void(const TranscriptSegment &segment)>;
+
+    explicit FileTranscriber(RecognitionSession session);
+
+    FileTranscriber(const FileTranscriber &) = delete;
+    FileTranscriber &operator=(const FileTranscriber &) = delete;
+
+    void setProgressCallback(ProgressCallback callback) { m_onProgress = std::move(callback); }
+    void setUtteranceCallback(UtteranceCallback callback) { m_onUtterance = std::move(callback); }
+    // Called with each timed segment as soon as it is decoded
+    void setSegmentCallback(SegmentCallback callback) { m_onSegment = std::move(callback); }
+    void setCancelFlag(const std::atomic<bool> *cancel) { m_cancel = cancel; }
+
+    // Skips the first |ms| of the input: nothing before it is decoded, but
+    // segment times and audioSeconds still count from the start of the file
+    void setStartMs(qint64 ms) { m_startMs = ms; }
+
+    // Format assumed for input without a WAV header (default 16 kHz mono s16le)
+    void setRawFormat(int sampleRate, int channels, AudioConverter::SampleFormat format);
+
+    FileTranscription transcribe(const QString &path);
+    FileTranscription transcribe(QIODevice *device, const QString &name);
+
+private:
+    // Large reads keep per-call overhead negligible in batch mode
+    static constexpr int READ_CHUNK_BYTES = 256 * 1024;
+    static constexpr int SAMPLE_RATE = 16000;
+
+    void handleResult(const char *json, FileTranscription &result);
+
+    RecognitionSession m_session;
+    qint64 m_fedOrigin = 0; // fed samples before this file; Vosk times count from creation
+    qint64 m_startMs = 0;
+    const std::atomic<bool> *m_cancel = nullptr;
+    ProgressCallback m_onProgress;
+    UtteranceCallback m_onUtterance;
+    SegmentCallback m_onSegment;
+
+    int m_rawSampleRate = SAMPLE_RATE;
+    int m_rawChannels = 1;
+    AudioConverter::SampleFormat m_rawFormat = AudioConverter::SampleFormat::Int16;
+
+    VoskResult m_result;
+    AudioConverter m_converter;
+    AlignedBuffer<char> m_readBuffer;
+    AlignedBuffer<int16_t> m_samples;
+};
+
+#endif // FILETRANSCRIBER_H
@@ -0,0 +1,169 @@
+#include "model_cache.h"
+#include "recognizer_pool.h"
+#include "vosk_api.h"
+
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#endif
+
+ModelCache::ModelCache(float sampleRate, size_t maxIdlePerModel, int64_t budgetBytes)
+    : m_sampleRate(sampleRate)
+    , m_maxIdlePerModel(maxIdlePerModel)
+    , m_budget(budgetBytes)
+{
+}
+
+ModelCache::~ModelCache()
+{
+    clear();
+}
+
+std::shared_ptr<RecognizerPool> ModelCache::acquire(const QString &path)
+{
+    const QString key = canonicalKey(path);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_loaded.wait(lock, [this, &key]() { return m_loading.count(key) == 0; });
+
+        auto it = findLocked(key);
+        if (it != m_entries.end()) {
+            return it->pool;
+        }
+        m_loading.insert(key);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<RecognizerPool> pool = RecognizerPool::create(
+        vosk_model_new(key.toUtf8().constData()), m_sampleRate, m_maxIdlePerModel);
+    const int64_t bytes = pool ? estimateBytes(key) : 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loading.erase(key);
+        if (pool) {
+            m_entries.push_front(Entry { key, pool, bytes });
+            m_residentBytes += bytes;
+            trimLocked();
+        }
+    }
+    m_loaded.notify_all();
+
+    if (pool) {
+        qDebug() << "Loaded model" << key << "in" << timer.elapsed() << "ms,"
+                 << bytes / (1024 * 1024) << "MB";
+    }
+    return pool;
+}
+
+std::shared_ptr<RecognizerPool> ModelCache::find(const QString &path)
+{
+    const QString key = canonicalKey(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = findLocked(key);
+    return it != m_entries.end() ? it->pool : nullptr;
+}
+
+void ModelCache::setBudget(int64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    trimLocked();
+}
+
+int64_t ModelCache::budget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+int64_t ModelCache::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+void ModelCache::clear()
+{
+    std::list<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entries.swap(m_entries);
+        m_residentBytes = 0;
+    }
+    // Pools are freed here, outside the lock
+}
+
+void ModelCache::prefetch(const QString &path)
+{
+#ifdef Q_OS_UNIX
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (file.open(QIODevice::ReadOnly)) {
+            posix_fadvise(file.handle(), 0, 0, POSIX_FADV_WILLNEED);
+        }
+    }
+#else
+    Q_UNUSED(path);
+#endif
+}
+
+QString ModelCache::canonicalKey(const QString &path)
+{
+    const QString canonical = QFileInfo(path).canonicalFilePath();
+    return canonical.isEmpty() ? path : canonical;
+}
+
+int64_t ModelCache::estimateBytes(const QString &path)
+{
+    // Vosk reads every file into memory, so the on-disk size is a fair
+    // lower bound for the resident footprint. Profile directories
+    // (ModelProfile) link to the model's files, hence following links.
+    int64_t total = 0;
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+std::list<ModelCache::Entry>::iterator ModelCache::findLocked(const QString &key)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->key == key) {
+            // Move to the front: most recently used
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return m_entries.begin();
+        }
+    }
+    return m_entries.end();
+}
+
+void ModelCache::trimLocked()
+{
+    // Walk from the least recently used end, skipping pools still in use and
+    // the entry just touched
+    auto it = m_entries.end();
+    while (m_residentBytes > m_budget && it != m_entries.begin()) {
+        --it;
+        if (it == m_entries.begin()) {
+            break;
+        }
+        if (it->pool.use_count() > 1) {
+            continue;
+        }
+        qDebug() << "Evicting model" << it->key << "from cache";
+        m_residentBytes -= it->bytes;
+        it = m_entries.erase(it);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <QString>
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+
+class RecognizerPool;
+
+// Keeps recently used models resident, keyed by canonical directory path.
+// Each entry is a RecognizerPool (which owns the VoskModel); callers share
+// it by reference count. Once the estimated footprint of resident models
+// exceeds the budget, the least recently used entries nobody else holds
+// are dropped. All methods are thread-safe; acquire() blocks while the
+// model loads, so call it off the GUI thread for models not yet resident.
+class ModelCache
+{
+public:
+    explicit ModelCache(float sampleRate, size_t maxIdlePerModel = 4,
+                        int64_t budgetBytes = DEFAULT_BUDGET_BYTES);
+    ~ModelCache();
+
+    ModelCache(const ModelCache &) = delete;
+    ModelCache &operator=(const ModelCache &) = delete;
+
+    // Resident pool for path, loading the model first if needed.
+    // Concurrent requests for the same path share a single load.
+    std::shared_ptr<RecognizerPool> acquire(const QString &path);
+
+    // Resident pool for path, or null; never loads
+    std::shared_ptr<RecognizerPool> find(const QString &path);
+
+    void setBudget(int64_t bytes);
+    int64_t budget() const;
+    int64_t residentBytes() const;
+
+    // Drops every entry; pools still referenced elsewhere stay alive
+    void clear();
+
+    // Asks the kernel to read the model files into the page cache, so a
+    // later vosk_model_new() is bound by memory copies rather than flash I/O
+    static void prefetch(const QString &path);
+
+    static constexpr int64_t DEFAULT_BUDGET_BYTES = 256LL * 1024 * 1024;
+
+private:
+    struct Entry
+    {
+        QString key;
+        std::shared_ptr<RecognizerPool> pool;
+        int64_t bytes = 0;
+    };
+
+    static QString canonicalKey(const QString &path);
+    static int64_t estimateBytes(const QString &path);
+
+    // Caller holds m_mutex
+    std::list<Entry>::iterator findLocked(const QString &key);
+    void trimLocked();
+
+    const float m_sampleRate;
+    const size_t m_maxIdlePerModel;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_loaded;
+    std::list<Entry> m_entries; // most recently used first
+    std::set<QString> m_loading;
+    int64_t m_budget;
+    int64_t m_residentBytes = 0;
+};
+
+#endif // MODELCACHE_H
@@ -0,0 +1,238 @@
+#include "model_profile.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+
+const int DEFAULT_VAD_HANGOVER_MS = 1000;
+const int VAD_HANGOVER_MARGIN_MS = 200;
+
+struct Scale
+{
+    const char *option;
+    double factor;
+    bool integer;
+};
+
+const Scale LOW_POWER_SCALES[] = {
+    { "--beam", 0.8, false },
+    { "--max-active", 0.5, true },
+    { "--min-active", 0.5, true },
+    { "--lattice-beam", 0.5, false },
+    { "--endpoint.rule2.min-trailing-silence", 0.8, false },
+    { "--endpoint.rule3.min-trailing-silence", 0.8, false },
+    { "--endpoint.rule4.min-trailing-silence", 0.8, false },
+};
+
+const Scale ACCURATE_SCALES[] = {
+    { "--beam", 1.3, false },
+    { "--max-active", 2.0, true },
+    { "--lattice-beam", 2.0, false },
+    { "--endpoint.rule2.min-trailing-silence", 1.2, false },
+    { "--endpoint.rule3.min-trailing-silence", 1.2, false },
+    { "--endpoint.rule4.min-trailing-silence", 1.2, false },
+};
+
+const Scale *findScale(ModelProfile::Profile profile, const QByteArray &option)
+{
+    const Scale *begin = nullptr;
+    const Scale *end = nullptr;
+    if (profile == ModelProfile::LowPower) {
+        begin = std::begin(LOW_POWER_SCALES);
+        end = std::end(LOW_POWER_SCALES);
+    } else if (profile == ModelProfile::Accurate) {
+        begin = std::begin(ACCURATE_SCALES);
+        end = std::end(ACCURATE_SCALES);
+    }
+    for (const Scale *scale = begin; scale != end; ++scale) {
+        if (option == scale->option) {
+            return scale;
+        }
+    }
+    return nullptr;
+}
+
+// Points |link| at |target| unless it already does
+bool ensureLink(const QString &target, const QString &link)
+{
+    const QFileInfo info(link);
+    if (info.isSymLink()) {
+        if (info.symLinkTarget() == target) {
+            return true;
+        }
+        QFile::remove(link);
+    }
+    return QFile::link(target, link);
+}
+
+} // namespace
+
+QString ModelProfile::name(Profile profile)
+{
+    switch (profile) {
+    case LowPower:
+        return QStringLiteral("low-power");
+    case Accurate:
+        return QStringLiteral("accurate");
+    case Balanced:
+    default:
+        return QStringLiteral("balanced");
+    }
+}
+
+bool ModelProfile::fromName(const QString &name, Profile *profile)
+{
+    for (Profile candidate : { LowPower, Balanced, Accurate }) {
+        if (name == ModelProfile::name(candidate)) {
+            *profile = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList ModelProfile::names()
+{
+    return { name(LowPower), name(Balanced), name(Accurate) };
+}
+
+QByteArray ModelProfile::rewriteConf(const QByteArray &conf, Profile profile)
+{
+    QByteArray out;
+    out.reserve(conf.size() + 64);
+    for (const QByteArray &line : conf.split('\n')) {
+        const int eq = line.indexOf('=');
+        const Scale *scale = eq > 0 ? findScale(profile, line.left(eq).trimmed()) : nullptr;
+        bool valid = false;
+        const double value = scale ? line.mid(eq + 1).trimmed().toDouble(&valid) : 0.0;
+        if (valid) {
+            const double scaled = value * scale->factor;
+            out += scale->option;
+            out += '=';
+            out += scale->integer ? QByteArray::number(qRound64(scaled))
+                                  : QByteArray::number(scaled, 'g', 4);
+        } else {
+            out += line;
+        }
+        out += '\n';
+    }
+    // split() yields an empty last piece for a trailing newline
+    if (conf.endsWith('\n')) {
+        out.chop(1);
+    }
+    return out;
+}
+
+int ModelProfile::endpointSilenceMs(const QByteArray &conf)
+{
+    static const QRegularExpression option(QStringLiteral("^--endpoint\\.rule(\\d+)\\.min-trailing-silence$"));
+    double longest = 0.0;
+    for (const QByteArray &line : conf.split('\n')) {
+        const int eq = line.indexOf('=');
+        if (eq <= 0) {
+            continue;
+        }
+        const QRegularExpressionMatch match = option.match(QString::fromLatin1(line.left(eq).trimmed()));
+        if (!match.hasMatch() || match.captured(1).toInt() < 2) {
+            continue;
+        }
+        bool valid = false;
+        const double seconds = line.mid(eq + 1).trimmed().toDouble(&valid);
+        if (valid) {
+            longest = std::max(longest, seconds);
+        }
+    }
+    return static_cast<int>(std::lround(longest * 1000.0));
+}
+
+int ModelProfile::vadHangoverMs(const QString &modelDir)
+{
+    QFile conf(modelDir + "/conf/model.conf");
+    if (!conf.open(QIODevice::ReadOnly)) {
+        return DEFAULT_VAD_HANGOVER_MS;
+    }
+    const int silenceMs = endpointSilenceMs(conf.readAll());
+    return silenceMs > 0 ? silenceMs + VAD_HANGOVER_MARGIN_MS : DEFAULT_VAD_HANGOVER_MS;
+}
+
+QString ModelProfile::prepare(const QString &modelDir, Profile profile, const QString &cacheDir, QString *error)
+{
+    const QString source = QFileInfo(modelDir).canonicalFilePath();
+    if (source.isEmpty()) {
+        if (error) {
+            *error = "Model directory not found: " + modelDir;
+        }
+        return QString();
+    }
+    if (profile == Balanced) {
+        return source;
+    }
+
+    QFile conf(source + "/conf/model.conf");
+    if (!conf.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = "Cannot read " + conf.fileName() + ": " + conf.errorString();
+        }
+        return QString();
+    }
+    const QByteArray rewritten = rewriteConf(conf.readAll(), profile);
+
+    // One directory per model path and profile
+    const QByteArray hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex().left(8);
+    const QString shadow = cacheDir + "/" + QFileInfo(source).fileName() + "-" + QString::fromLatin1(hash)
+        + "/" + name(profile);
+    if (!QDir().mkpath(shadow + "/conf")) {
+        if (error) {
+            *error = "Cannot create " + shadow;
+        }
+        return QString();
+    }
+
+    // Everything but conf/model.conf is the model's own file
+    const QDir::Filters filters = QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot;
+    for (const QFileInfo &entry : QDir(source).entryInfoList(filters)) {
+        if (entry.fileName() == "conf") {
+            continue;
+        }
+        if (!ensureLink(entry.absoluteFilePath(), shadow + "/" + entry.fileName())) {
+            if (error) {
+                *error = "Cannot link " + entry.absoluteFilePath() + " into " + shadow;
+            }
+            return QString();
+        }
+    }
+    for (const QFileInfo &entry : QDir(source + "/conf").entryInfoList(filters)) {
+        if (entry.fileName() == "model.conf") {
+            continue;
+        }
+        if (!ensureLink(entry.absoluteFilePath(), shadow + "/conf/" + entry.fileName())) {
+            if (error) {
+                *error = "Cannot link " + entry.absoluteFilePath() + " into " + shadow;
+            }
+            return QString();
+        }
+    }
+
+    QFile existing(shadow + "/conf/model.conf");
+    if (!existing.open(QIODevice::ReadOnly) || existing.readAll() != rewritten) {
+        existing.close();
+        QSaveFile out(shadow + "/conf/model.conf");
+        if (!out.open(QIODevice::WriteOnly) || out.write(rewritten) != rewritten.size() || !out.commit()) {
+            if (error) {
+                *error = "Cannot write " + out.fileName() + ": " + out.errorString();
+            }
+            return QString();
+        }
+    }
+    return shadow;
+}
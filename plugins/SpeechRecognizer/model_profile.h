@@ -0,0 +1,55 @@
+#ifndef MODELPROFILE_H
+#define MODELPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+// Decoder settings traded for speed or accuracy. Vosk only reads them from
+// the model's conf/model.conf, so a profile other than Balanced loads the
+// model from a shadow directory: links to the model's files plus a
+// rewritten model.conf. The shadow directory is a distinct path, so each
+// profile is cached (and evicted) by ModelCache like a separate model.
+//
+// Settings are scaled relative to the model's own, since small and large
+// models ship very different beams:
+//   low-power  beam x0.8, max/min-active x0.5, lattice-beam x0.5,
+//              endpoint silences x0.8 (finals arrive sooner)
+//   balanced   the model as shipped
+//   accurate   beam x1.3, max-active x2, lattice-beam x2,
+//              endpoint silences x1.2 (fewer cuts mid-sentence)
+class ModelProfile
+{
+public:
+    enum Profile {
+        LowPower,
+        Balanced,
+        Accurate
+    };
+
+    static QString name(Profile profile);
+    static bool fromName(const QString &name, Profile *profile);
+    static QStringList names();
+
+    // Directory to load |modelDir| from with |profile|'s settings: the
+    // model itself for Balanced, otherwise a shadow directory under
+    // |cacheDir|, created or refreshed as needed. Empty on failure, with
+    // the reason in |error|.
+    static QString prepare(const QString &modelDir, Profile profile, const QString &cacheDir,
+                           QString *error = nullptr);
+
+    // model.conf text with |profile|'s scaling applied to |conf|
+    static QByteArray rewriteConf(const QByteArray &conf, Profile profile);
+
+    // Longest trailing silence after speech that an endpoint rule of |conf|
+    // waits for (rule2 and up; rule1 only ends stretches without speech),
+    // in milliseconds; 0 if the conf sets none
+    static int endpointSilenceMs(const QByteArray &conf);
+
+    // How long the VAD must keep feeding silence after speech so every
+    // endpoint rule of the model (or profile directory) at |modelDir| can
+    // still fire: its longest trailing silence plus a margin, or the VAD's
+    // default if model.conf can't be read
+    static int vadHangoverMs(const QString &modelDir);
+};
+
+#endif // MODELPROFILE_H
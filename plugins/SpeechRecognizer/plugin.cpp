@@ -3,11 +3,15 @@
 
 #include "plugin.h"
 #include "speech_recognizer.h"
+#include "transcript_model.h"
 
 void SpeechRecognizerPlugin::registerTypes(const char *uri)
 {
     Q_ASSERT(uri == QLatin1String("SpeechRecognizer"));
     
+    qmlRegisterUncreatableType<TranscriptModel>(
+        uri, 1, 0, "TranscriptModel", "TranscriptModel is provided by SpeechRecognizer.transcript");
+    
     // Register SpeechRecognizer as a singleton
     qmlRegisterSingletonType<SpeechRecognizer>(
         uri, 1, 0, "SpeechRecognizer",
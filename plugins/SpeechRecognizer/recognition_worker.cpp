@@ -0,0 +1,587 @@
+#include "recognition_worker.h"
+#include "audio_ring_buffer.h"
+#include "vosk_api.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+RecognitionWorker::RecognitionWorker(AudioRingBuffer *ring, QObject *parent)
+    : QObject(parent)
+    , m_ring(ring)
+    , m_chunk(MAX_CHUNK_SAMPLES)
+    , m_vad(SAMPLE_RATE)
+{
+    qRegisterMetaType<TranscriptSegment>();
+    m_voiced.resize(m_vad.maxOutputSamples(MAX_CHUNK_SAMPLES));
+    m_feedMap.reserve(16);
+    setMaxBacklogMs(DEFAULT_MAX_BACKLOG_MS);
+}
+
+RecognitionWorker::~RecognitionWorker()
+{
+    releaseRecognizer();
+}
+
+bool RecognitionWorker::createRecognizer(const std::shared_ptr<RecognizerPool> &pool)
+{
+    if (!pool) {
+        releaseRecognizer();
+        return false;
+    }
+
+    // The current recognizer stays until the new one exists
+    RecognitionSession session = pool->acquire(m_grammar);
+    if (!session) {
+        return false;
+    }
+    releaseRecognizer();
+    m_session = std::move(session);
+    m_session.setSpeakerModel(m_speakerModel);
+    m_session.setMaxAlternatives(m_maxAlternatives);
+    m_recognizer = m_session.recognizer();
+    resetFeedMap();
+
+    // Audio queued while the model was loading can be decoded now
+    if (m_recognizer && m_running) {
+        wake();
+    }
+    return m_recognizer != nullptr;
+}
+
+void RecognitionWorker::releaseRecognizer()
+{
+    m_pendingPool.reset();
+    m_session.release();
+    m_recognizer = nullptr;
+}
+
+bool RecognitionWorker::switchModel(const std::shared_ptr<RecognizerPool> &pool)
+{
+    if (!m_recognizer || !m_running) {
+        return createRecognizer(pool);
+    }
+
+    m_pendingPool = pool;
+    return pool != nullptr;
+}
+
+bool RecognitionWorker::setGrammar(const std::string &grammar)
+{
+    const std::string previous = m_grammar;
+    m_grammar = grammar;
+    if (!renewRecognizer()) {
+        m_grammar = previous;
+        return false;
+    }
+    return true;
+}
+
+void RecognitionWorker::requestModel(const std::shared_ptr<RecognizerPool> &pool)
+{
+    emit modelSwitched(switchModel(pool));
+}
+
+void RecognitionWorker::requestGrammar(const QString &grammar)
+{
+    emit grammarApplied(grammar, setGrammar(grammar.toStdString()));
+}
+
+bool RecognitionWorker::setSpeakerModel(VoskSpkModel *model)
+{
+    VoskSpkModel *previous = m_speakerModel;
+    m_speakerModel = model;
+    if (!renewRecognizer()) {
+        m_speakerModel = previous;
+        return false;
+    }
+    return true;
+}
+
+void RecognitionWorker::requestSpeakerModel(VoskSpkModel *model)
+{
+    emit speakerModelApplied(setSpeakerModel(model));
+}
+
+void RecognitionWorker::setMaxAlternatives(int count)
+{
+    m_maxAlternatives = std::max(0, count);
+    m_session.setMaxAlternatives(m_maxAlternatives);
+}
+
+void RecognitionWorker::setRecognizerLifetimeMs(int ms)
+{
+    m_lifetimeSamples = static_cast<qint64>(std::max(0, ms)) * SAMPLE_RATE / 1000;
+}
+
+bool RecognitionWorker::renewRecognizer()
+{
+    // A model switch already waiting picks up the new settings as well
+    std::shared_ptr<RecognizerPool> pool = m_pendingPool ? m_pendingPool : m_session.pool();
+    if (!pool) {
+        return true; // applied when a recognizer is created
+    }
+    return switchModel(pool);
+}
+
+void RecognitionWorker::applyPendingModel()
+{
+    if (!m_pendingPool) {
+        return;
+    }
+
+    std::shared_ptr<RecognizerPool> pool = std::move(m_pendingPool);
+    RecognitionSession session = pool->acquire(m_grammar);
+    session.setSpeakerModel(m_speakerModel);
+    session.setMaxAlternatives(m_maxAlternatives);
+    if (!session) {
+        qWarning() << "Could not create a recognizer for the new model or grammar, keeping the current one";
+        return;
+    }
+
+    // Whatever the old recognizer still holds belongs to the old model
+    emitResult(vosk_recognizer_final_result(m_recognizer));
+    adoptSession(std::move(session));
+    qDebug() << "Switched recognizer" << (m_grammar.empty() ? "(unconstrained)" : "(grammar)");
+}
+
+void RecognitionWorker::retireExpiredRecognizer()
+{
+    // Only called right after a final result, so nothing is in flight
+    if (m_lifetimeSamples <= 0 || !m_recognizer || m_session.fedSamples() < m_lifetimeSamples) {
+        return;
+    }
+
+    RecognitionSession session = m_session.pool()->acquire(m_grammar);
+    session.setSpeakerModel(m_speakerModel);
+    session.setMaxAlternatives(m_maxAlternatives);
+    if (!session) {
+        qWarning() << "Could not create a fresh recognizer, keeping the current one";
+        return;
+    }
+
+    const qint64 fed = m_session.fedSamples();
+    adoptSession(std::move(session), true);
+    qDebug() << "Replaced recognizer after" << fed / SAMPLE_RATE << "s of audio";
+}
+
+void RecognitionWorker::adoptSession(RecognitionSession session, bool discardOld)
+{
+    // The new recognizer has its own fed-sample clock; continue the map
+    // from wherever the old one stopped
+    const qint64 next = sessionSample(m_session.fedSamples());
+    if (discardOld) {
+        m_session.discard();
+    }
+    m_session = std::move(session);
+    m_recognizer = m_session.recognizer();
+    m_feedMap.clear();
+    mapFeed(m_session.fedSamples(), next);
+}
+
+void RecognitionWorker::setVadEnabled(bool enabled)
+{
+    m_vadEnabled = enabled;
+    m_vad.reset();
+    m_vadOrigin = m_consumedSamples;
+    updateSpeechActive();
+}
+
+void RecognitionWorker::setOverflowPolicy(OverflowPolicy policy)
+{
+    m_overflowPolicy = policy;
+}
+
+void RecognitionWorker::setMaxBacklogMs(int ms)
+{
+    // At least one chunk, and less than half the ring so drop policies act
+    // before the producer has to discard new audio
+    const int limit = static_cast<int>(m_ring->capacity() / 2);
+    m_maxBacklogSamples = qBound(MAX_CHUNK_SAMPLES, ms * (SAMPLE_RATE / 1000), limit);
+}
+
+void RecognitionWorker::setVadEnergyThreshold(float dbfs)
+{
+    m_vad.setEnergyThreshold(dbfs);
+}
+
+void RecognitionWorker::setVadZeroCrossingThreshold(float rate)
+{
+    m_vad.setZeroCrossingThreshold(rate);
+}
+
+void RecognitionWorker::setVadHangoverMs(int ms)
+{
+    m_vad.setHangoverMs(ms);
+}
+
+void RecognitionWorker::reset()
+{
+    resetAt(NO_SESSION_END);
+}
+
+void RecognitionWorker::resetAt(size_t position)
+{
+    // Drop anything left over from a previous session
+    if (position == NO_SESSION_END) {
+        m_ring->discard();
+    } else {
+        m_ring->skip(position - m_ring->read());
+    }
+    m_consumedSamples = 0;
+    m_chunkStartSample = 0;
+    m_chunkSamples.store(MIN_CHUNK_SAMPLES, std::memory_order_relaxed);
+    m_droppedSamples.store(0, std::memory_order_relaxed);
+    m_lateSamples.store(0, std::memory_order_relaxed);
+    m_vad.reset();
+    m_vadOrigin = 0;
+    updateSpeechActive();
+    resetPartial();
+    resetFeedMap();
+
+    if (m_recognizer) {
+        vosk_recognizer_reset(m_recognizer);
+        applyPendingModel();
+        retireExpiredRecognizer();
+    }
+}
+
+void RecognitionWorker::start()
+{
+    m_running = true;
+    wake();
+}
+
+void RecognitionWorker::wake()
+{
+    if (m_ring->available() < static_cast<size_t>(MIN_CHUNK_SAMPLES)) {
+        return;
+    }
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &RecognitionWorker::drain, Qt::QueuedConnection);
+    }
+}
+
+void RecognitionWorker::endSessionAt(size_t position)
+{
+    std::lock_guard<std::mutex> lock(m_sessionEndMutex);
+    m_sessionEnds.push_back(position);
+    if (m_sessionEnds.size() == 1) {
+        m_sessionEnd.store(position, std::memory_order_release);
+    }
+}
+
+qint64 RecognitionWorker::backlogSamples() const
+{
+    return static_cast<qint64>(m_ring->available());
+}
+
+void RecognitionWorker::drain()
+{
+    drainAvailable(false);
+}
+
+size_t RecognitionWorker::drainableSamples() const
+{
+    // Audio past the end of a stopped recording belongs to the next one
+    const size_t available = m_ring->available();
+    const size_t end = m_sessionEnd.load(std::memory_order_acquire);
+    if (end == NO_SESSION_END) {
+        return available;
+    }
+    return std::min(available, end - m_ring->read());
+}
+
+void RecognitionWorker::drainAvailable(bool flush)
+{
+    // Cleared before popping, so a push after this point posts a new drain
+    m_wakePending.exchange(false, std::memory_order_acq_rel);
+
+    // Without a recognizer (model still loading) audio stays queued in the ring
+    if (!m_recognizer) {
+        return;
+    }
+
+    for (;;) {
+        // Admission: keep the backlog within budget according to the policy
+        size_t backlog = drainableSamples();
+        const bool overBudget = backlog > static_cast<size_t>(m_maxBacklogSamples);
+        if (overBudget && (m_overflowPolicy == DropOldest
+                           || (m_overflowPolicy == DropSilenceFirst && backlog > 2 * static_cast<size_t>(m_maxBacklogSamples)))) {
+            size_t excess = backlog - m_maxBacklogSamples;
+            excess -= excess % MIN_CHUNK_SAMPLES;
+            dropSamples(m_ring->skip(excess));
+            backlog = drainableSamples();
+        }
+
+        // Whole 30 ms steps only; a shorter remainder waits for more audio
+        // unless this is the final flush
+        size_t count = std::min(backlog, static_cast<size_t>(chunkSamples()));
+        if (!flush) {
+            count -= count % MIN_CHUNK_SAMPLES;
+        }
+        if (count == 0) {
+            break;
+        }
+        count = m_ring->pop(m_chunk.data(), count);
+
+        // Silent audio is the cheapest to lose when behind
+        if (overBudget && m_overflowPolicy == DropSilenceFirst
+            && m_vad.isSilent(m_chunk.data(), static_cast<int>(count))) {
+            dropSamples(count);
+            continue;
+        }
+
+        // The oldest queued sample has waited longer than the budget
+        if (backlog > static_cast<size_t>(m_maxBacklogSamples)) {
+            m_lateSamples.fetch_add(static_cast<qint64>(count), std::memory_order_relaxed);
+        }
+
+        m_chunkStartSample = m_consumedSamples;
+        m_consumedSamples += static_cast<qint64>(count);
+
+        if (!m_vadEnabled) {
+            mapFeed(m_session.fedSamples(), m_chunkStartSample);
+            decode(m_chunk.data(), static_cast<int>(count));
+            adaptChunkSize(m_ring->available());
+            continue;
+        }
+
+        // Only voiced audio (plus pre-roll and hangover) reaches Vosk
+        int voiced = m_vad.process(m_chunk.data(), static_cast<int>(count), m_voiced.data());
+        const qint64 fed = m_session.fedSamples();
+        for (const VoiceActivityDetector::Run &run : m_vad.runs()) {
+            mapFeed(fed + run.outputOffset, m_vadOrigin + run.inputPosition);
+        }
+        updateSpeechActive();
+        decode(m_voiced.data(), voiced);
+
+        // Silence after hangover is a boundary even without a Vosk endpoint
+        if (!m_vad.isSpeechActive()) {
+            applyPendingModel();
+        }
+
+        adaptChunkSize(m_ring->available());
+    }
+}
+
+void RecognitionWorker::dropSamples(size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Session time still advances over the gap; the VAD never sees it
+    m_consumedSamples += static_cast<qint64>(count);
+    m_vadOrigin += static_cast<qint64>(count);
+    m_droppedSamples.fetch_add(static_cast<qint64>(count), std::memory_order_relaxed);
+}
+
+void RecognitionWorker::adaptChunkSize(size_t backlog)
+{
+    // More than a chunk queued behind this one means the decoder is slower
+    // than real time at this size: take bigger bites so fixed per-call costs
+    // (partial result extraction, endpoint checks) are paid less often.
+    // Once caught up, go back towards the smallest step for lowest latency.
+    const int size = chunkSamples();
+    int next = size;
+    if (backlog > static_cast<size_t>(size)) {
+        next = std::min(size * 2, MAX_CHUNK_SAMPLES);
+    } else if (backlog < static_cast<size_t>(MIN_CHUNK_SAMPLES)) {
+        next = std::max(size / 2, MIN_CHUNK_SAMPLES);
+    }
+    if (next != size) {
+        m_chunkSamples.store(next, std::memory_order_relaxed);
+    }
+}
+
+void RecognitionWorker::decode(const int16_t *samples, int count)
+{
+    if (!m_recognizer || count <= 0) {
+        return;
+    }
+
+    // Feed audio data to Vosk
+    int accepted = m_session.acceptWaveform(samples, count);
+
+    if (accepted) {
+        // We have a complete utterance
+        emitResult(vosk_recognizer_result(m_recognizer));
+        applyPendingModel();
+        retireExpiredRecognizer();
+    } else {
+        // Get partial result for live feedback
+        emitPartial();
+    }
+}
+
+void RecognitionWorker::emitPartial()
+{
+    if (!m_result.parse(vosk_recognizer_partial_result(m_recognizer))) {
+        return;
+    }
+
+    // Most chunks leave the hypothesis unchanged; don't wake the UI for those
+    const char *text = m_result.text();
+    const size_t length = static_cast<size_t>(m_result.textLength());
+    if (length == m_lastPartial.size() && std::memcmp(text, m_lastPartial.data(), length) == 0) {
+        return;
+    }
+
+    // Words before the last space inside the shared prefix are identical
+    // in both hypotheses and count as stable
+    const size_t limit = std::min(length, m_lastPartial.size());
+    size_t common = 0;
+    while (common < limit && text[common] == m_lastPartial[common]) {
+        ++common;
+    }
+    size_t tailStart = common;
+    while (tailStart > 0 && text[tailStart - 1] != ' ') {
+        --tailStart;
+    }
+    const size_t stableLength = tailStart > 0 ? tailStart - 1 : 0;
+
+    if (m_utteranceStartSample < 0 && length > 0) {
+        m_utteranceStartSample = m_chunkStartSample;
+    }
+
+    m_lastPartial.assign(text, length);
+    emit partialResult(QString::fromUtf8(text, static_cast<int>(stableLength)),
+                       QString::fromUtf8(text + tailStart, static_cast<int>(length - tailStart)));
+}
+
+void RecognitionWorker::resetPartial()
+{
+    m_utteranceStartSample = -1;
+    if (!m_lastPartial.empty()) {
+        m_lastPartial.clear();
+        emit partialResult(QString(), QString());
+    }
+}
+
+void RecognitionWorker::finish()
+{
+    m_running = false;
+    drainAvailable(true);
+    m_vad.reset();
+    m_vadOrigin = m_consumedSamples;
+    updateSpeechActive();
+
+    if (m_recognizer) {
+        emitResult(vosk_recognizer_final_result(m_recognizer));
+        applyPendingModel();
+    }
+
+    // Draining may go on up to the next stopped recording, if any
+    {
+        std::lock_guard<std::mutex> lock(m_sessionEndMutex);
+        if (!m_sessionEnds.empty()) {
+            m_sessionEnds.pop_front();
+        }
+        m_sessionEnd.store(m_sessionEnds.empty() ? NO_SESSION_END : m_sessionEnds.front(),
+                           std::memory_order_release);
+    }
+    emit finished();
+}
+
+void RecognitionWorker::updateSpeechActive()
+{
+    bool active = m_vadEnabled && m_vad.isSpeechActive();
+    if (active != m_speechActive) {
+        m_speechActive = active;
+        emit speechActiveChanged(active);
+    }
+}
+
+void RecognitionWorker::emitResult(const char *json)
+{
+    if (m_result.parse(json) && !m_result.isEmpty()) {
+        TranscriptSegment segment;
+        segment.text = m_result.textString();
+
+        const std::vector<VoskWord> &words = m_result.words();
+        if (!words.empty()) {
+            segment.words.reserve(static_cast<int>(words.size()));
+            float sum = 0.0f;
+            for (const VoskWord &word : words) {
+                TranscriptWord w;
+                w.text = QString::fromUtf8(word.text, word.length);
+                w.startMs = sessionSample(qRound64(word.start * SAMPLE_RATE)) * 1000 / SAMPLE_RATE;
+                w.endMs = sessionSample(qRound64(word.end * SAMPLE_RATE)) * 1000 / SAMPLE_RATE;
+                w.confidence = word.conf;
+                segment.words.append(w);
+                sum += word.conf;
+            }
+            segment.confidence = sum / words.size();
+            segment.startMs = segment.words.first().startMs;
+            segment.endMs = segment.words.last().endMs;
+
+            // Later utterances can't refer to audio before this one's end
+            const qint64 endFed = qRound64(words.back().end * SAMPLE_RATE);
+            auto span = std::upper_bound(m_feedMap.begin(), m_feedMap.end(), endFed,
+                                         [](qint64 value, const FeedSpan &s) { return value < s.fedStart; });
+            if (span - m_feedMap.begin() > 1) {
+                m_feedMap.erase(m_feedMap.begin(), span - 1);
+            }
+        } else {
+            // Without word times, place the segment by where in the session
+            // its audio was consumed
+            const qint64 start = m_utteranceStartSample >= 0 ? m_utteranceStartSample : m_chunkStartSample;
+            segment.startMs = start * 1000 / SAMPLE_RATE;
+            segment.endMs = m_consumedSamples * 1000 / SAMPLE_RATE;
+        }
+
+        // Copied raw; parsed only if someone opens the list
+        if (m_result.alternativeCount() > 1) {
+            segment.alternatives = QByteArray(m_result.alternatives(), m_result.alternativesLength());
+            segment.alternativeCount = m_result.alternativeCount();
+        }
+
+        const std::vector<float> &speaker = m_result.speakerVector();
+        if (!speaker.empty()) {
+            segment.speakerVector.resize(static_cast<int>(speaker.size()));
+            std::copy(speaker.begin(), speaker.end(), segment.speakerVector.begin());
+        }
+
+        emit finalResult(segment);
+    }
+    resetPartial();
+}
+
+void RecognitionWorker::resetFeedMap()
+{
+    m_feedMap.clear();
+    if (m_session) {
+        mapFeed(m_session.fedSamples(), m_consumedSamples);
+    }
+}
+
+void RecognitionWorker::mapFeed(qint64 fedStart, qint64 sessionStart)
+{
+    if (!m_feedMap.empty()) {
+        FeedSpan &last = m_feedMap.back();
+        if (sessionStart - last.sessionStart == fedStart - last.fedStart) {
+            return; // continues the previous span
+        }
+        if (fedStart == last.fedStart) {
+            last.sessionStart = sessionStart; // nothing was fed in between
+            return;
+        }
+    }
+    m_feedMap.push_back(FeedSpan { fedStart, sessionStart });
+}
+
+qint64 RecognitionWorker::sessionSample(qint64 fed) const
+{
+    if (m_feedMap.empty()) {
+        return fed;
+    }
+    auto it = std::upper_bound(m_feedMap.begin(), m_feedMap.end(), fed, [](qint64 value, const FeedSpan &span) {
+        return value < span.fedStart;
+    });
+    if (it != m_feedMap.begin()) {
+        --it;
+    }
+    return it->sessionStart + (fed - it->fedStart);
+}
@@ -0,0 +1,220 @@
+#ifndef RECOGNITIONWORKER_H
+#define RECOGNITIONWORKER_H
+
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "recognizer_pool.h"
+#include "transcript_segment.h"
+#include "voice_activity_detector.h"
+#include "vosk_result.h"
+
+class AudioRingBuffer;
+struct VoskSpkModel;
+
+// Holds a pooled VoskRecognizer and runs all decoding on its own thread.
+// SpeechRecognizer moves an instance to a QThread and talks to it only
+// through queued calls, so the GUI thread never touches the decoder.
+//
+// Pipeline: capture (producer thread) -> ring buffer -> admission ->
+// preprocess (VAD) -> decode -> postprocess (result signals). The ring is
+// the only queue that can grow; admission keeps it within the backlog
+// budget according to the overflow policy. Between the later stages there
+// is at most one chunk in flight, and partial results are coalesced.
+// The producer calls wake() after each push and the worker drains as soon
+// as a minimum chunk is queued.
+class RecognitionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // What happens when more audio is queued than the backlog budget
+    enum OverflowPolicy {
+        Block,           // keep everything; the producer stops taking audio when the ring is full
+        DropOldest,      // skip the oldest audio down to the budget
+        DropSilenceFirst // skip silent chunks; the oldest audio only at twice the budget
+    };
+    Q_ENUM(OverflowPolicy)
+
+    // Vosk models decode 10 ms frames with a frame-subsampling-factor of 3,
+    // so the decoder advances in 30 ms steps; chunks are whole steps
+    static constexpr int MIN_CHUNK_SAMPLES = 16000 * 30 / 1000;
+    static constexpr int MAX_CHUNK_SAMPLES = MIN_CHUNK_SAMPLES * 32; // 0.96 s
+
+    explicit RecognitionWorker(AudioRingBuffer *ring, QObject *parent = nullptr);
+    ~RecognitionWorker();
+
+    // Must be called on the worker thread
+    bool createRecognizer(const std::shared_ptr<RecognizerPool> &pool);
+    void releaseRecognizer();
+
+    // Moves to a recognizer from another pool. While a session is running
+    // the switch waits for the next utterance boundary, so no utterance is
+    // split across two models; otherwise it happens immediately.
+    bool switchModel(const std::shared_ptr<RecognizerPool> &pool);
+
+    // Constrains recognition to a JSON phrase list (see VoskGrammar), or
+    // lifts the constraint if empty. Takes effect like a model switch, at
+    // the next utterance boundary while running.
+    bool setGrammar(const std::string &grammar);
+
+    // The same for queued calls from the GUI thread, which must not wait
+    // while a recognizer is created or a grammar compiled; the outcome is
+    // reported by modelSwitched() / grammarApplied(). On failure the
+    // previous recognizer and grammar stay in use.
+    void requestModel(const std::shared_ptr<RecognizerPool> &pool);
+    void requestGrammar(const QString &grammar);
+
+    // Attaches a speaker model so final results carry an x-vector, or
+    // detaches it if null. Also applied at the next utterance boundary.
+    // The caller keeps the model alive while it is set. On failure the
+    // previous model stays attached.
+    bool setSpeakerModel(VoskSpkModel *model);
+    // Queued variant; the outcome is reported by speakerModelApplied()
+    void requestSpeakerModel(VoskSpkModel *model);
+
+    // Final results carry up to |count| hypotheses (0: single best).
+    // Takes effect from the next result.
+    void setMaxAlternatives(int count);
+
+    // For continuous sessions: once the recognizer has decoded |ms| of
+    // audio it is replaced by a fresh one at the next utterance boundary,
+    // so its state and time base don't grow with the session. 0 keeps it.
+    void setRecognizerLifetimeMs(int ms);
+
+    void setVadEnabled(bool enabled);
+    void setOverflowPolicy(OverflowPolicy policy);
+    void setMaxBacklogMs(int ms);
+    void setVadEnergyThreshold(float dbfs);
+    void setVadZeroCrossingThreshold(float rate);
+    // Trailing silence still fed to the decoder after speech; see
+    // ModelProfile::vadHangoverMs()
+    void setVadHangoverMs(int ms);
+
+    // Thread-safe; called by the producer after pushing to the ring.
+    // Schedules one drain once at least MIN_CHUNK_SAMPLES are queued;
+    // further calls are coalesced until that drain starts.
+    void wake();
+
+    // Thread-safe; called with the ring's written() position when capture
+    // stops, before finish() is queued for that recording. Drains and the
+    // matching finish() stop there, so a recording started while this one
+    // is finalizing keeps its audio for the next session.
+    void endSessionAt(size_t position);
+
+    // Current decode chunk size and samples waiting in the ring. The chunk
+    // grows while the decoder is behind real time and shrinks back once it
+    // has caught up. Thread-safe.
+    int chunkSamples() const { return m_chunkSamples.load(std::memory_order_relaxed); }
+    qint64 backlogSamples() const;
+
+    // Since the last reset(): samples skipped by the overflow policy, and
+    // samples decoded after waiting longer than the backlog budget.
+    // Thread-safe.
+    qint64 droppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
+    qint64 lateSamples() const { return m_lateSamples.load(std::memory_order_relaxed); }
+
+    // Samples taken from the ring since the last reset(), silence included.
+    // Only meaningful on the worker thread (e.g. from a direct connection).
+    qint64 consumedSamples() const { return m_consumedSamples; }
+
+public slots:
+    void reset();
+    // Like reset(), but drops only audio queued before |position|; anything
+    // after it was captured for the session about to start
+    void resetAt(size_t position);
+    void start();
+    void drain();
+    void finish();
+
+signals:
+    // Emitted only when the hypothesis changes. stable holds the leading
+    // words the previous hypothesis agreed on, tail the words still being
+    // revised. Both empty once the utterance is finalized.
+    void partialResult(const QString &stable, const QString &tail);
+    void finalResult(const TranscriptSegment &segment);
+    void speechActiveChanged(bool active);
+    // Emitted at the end of finish(), after the session's last finalResult
+    void finished();
+    void modelSwitched(bool ok);
+    void grammarApplied(const QString &grammar, bool ok);
+    void speakerModelApplied(bool ok);
+
+private:
+    void drainAvailable(bool flush);
+    size_t drainableSamples() const;
+    void dropSamples(size_t count);
+    void adaptChunkSize(size_t backlog);
+    void decode(const int16_t *samples, int count);
+    void emitPartial();
+    void emitResult(const char *json);
+    void resetPartial();
+    void updateSpeechActive();
+    void applyPendingModel();
+    bool renewRecognizer();
+    void retireExpiredRecognizer();
+    void adoptSession(RecognitionSession session, bool discardOld = false);
+    void resetFeedMap();
+    void mapFeed(qint64 fedStart, qint64 sessionStart);
+    qint64 sessionSample(qint64 fed) const;
+
+    AudioRingBuffer *m_ring = nullptr;
+    RecognitionSession m_session;
+    VoskRecognizer *m_recognizer = nullptr; // m_session.recognizer()
+    std::shared_ptr<RecognizerPool> m_pendingPool;
+    std::string m_grammar;
+    VoskSpkModel *m_speakerModel = nullptr;
+    int m_maxAlternatives = 0;
+    qint64 m_lifetimeSamples = 0;
+    VoskResult m_result;
+    std::string m_lastPartial; // UTF-8, keeps its capacity between utterances
+    bool m_running = false; // between start() and finish()
+
+    // Ring positions where stopped recordings end, oldest first; the front
+    // one bounds draining until its finish() has run
+    static constexpr size_t NO_SESSION_END = std::numeric_limits<size_t>::max();
+    std::mutex m_sessionEndMutex;
+    std::deque<size_t> m_sessionEnds;
+    std::atomic<size_t> m_sessionEnd{NO_SESSION_END};
+    std::atomic<bool> m_wakePending{false};
+    std::atomic<int> m_chunkSamples{MIN_CHUNK_SAMPLES};
+    OverflowPolicy m_overflowPolicy = DropSilenceFirst;
+    int m_maxBacklogSamples = 0;
+    std::atomic<qint64> m_droppedSamples{0};
+    std::atomic<qint64> m_lateSamples{0};
+    AlignedBuffer<int16_t> m_chunk;
+    qint64 m_consumedSamples = 0;
+    qint64 m_chunkStartSample = 0;      // session position of the current chunk
+    qint64 m_utteranceStartSample = -1; // chunk that produced the first partial
+
+    // Vosk word times count samples fed to the recognizer since it was
+    // created, which skips whatever the VAD dropped. Each span maps a
+    // contiguous run of fed samples back to session position.
+    struct FeedSpan
+    {
+        qint64 fedStart;
+        qint64 sessionStart;
+    };
+    std::vector<FeedSpan> m_feedMap;
+    qint64 m_vadOrigin = 0; // session position of the VAD's last reset
+
+    // Silence gating in front of the decoder
+    VoiceActivityDetector m_vad;
+    AlignedBuffer<int16_t> m_voiced;
+    bool m_vadEnabled = true;
+    bool m_speechActive = false;
+
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr int DEFAULT_MAX_BACKLOG_MS = 3000;
+};
+
+#endif // RECOGNITIONWORKER_H
@@ -0,0 +1,240 @@
+#include "recognizer_pool.h"
+#include "vosk_api.h"
+
+#include <iterator>
+#include <utility>
+
+RecognitionSession::RecognitionSession(std::shared_ptr<RecognizerPool> pool, VoskRecognizer *recognizer,
+                                       int64_t fedSamples, std::string grammar)
+    : m_pool(std::move(pool))
+    , m_recognizer(recognizer)
+    , m_fedSamples(fedSamples)
+    , m_grammar(std::move(grammar))
+{
+}
+
+RecognitionSession::~RecognitionSession()
+{
+    release();
+}
+
+RecognitionSession::RecognitionSession(RecognitionSession &&other) noexcept
+    : m_pool(std::move(other.m_pool))
+    , m_recognizer(std::exchange(other.m_recognizer, nullptr))
+    , m_fedSamples(std::exchange(other.m_fedSamples, 0))
+    , m_grammar(std::move(other.m_grammar))
+    , m_speaker(std::exchange(other.m_speaker, false))
+    , m_maxAlternatives(std::exchange(other.m_maxAlternatives, 0))
+{
+}
+
+RecognitionSession &RecognitionSession::operator=(RecognitionSession &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_pool = std::move(other.m_pool);
+        m_recognizer = std::exchange(other.m_recognizer, nullptr);
+        m_fedSamples = std::exchange(other.m_fedSamples, 0);
+        m_grammar = std::move(other.m_grammar);
+        m_speaker = std::exchange(other.m_speaker, false);
+        m_maxAlternatives = std::exchange(other.m_maxAlternatives, 0);
+    }
+    return *this;
+}
+
+int RecognitionSession::acceptWaveform(const int16_t *samples, int count)
+{
+    m_fedSamples += count;
+    return vosk_recognizer_accept_waveform_s(m_recognizer, samples, count);
+}
+
+void RecognitionSession::setSpeakerModel(VoskSpkModel *model)
+{
+    if (m_recognizer && model) {
+        vosk_recognizer_set_spk_model(m_recognizer, model);
+        m_speaker = true;
+    }
+}
+
+void RecognitionSession::setMaxAlternatives(int count)
+{
+    if (m_recognizer && count != m_maxAlternatives) {
+        vosk_recognizer_set_max_alternatives(m_recognizer, count);
+        m_maxAlternatives = count;
+    }
+}
+
+void RecognitionSession::release()
+{
+    if (m_recognizer) {
+        if (m_speaker) {
+            m_pool->discard(m_recognizer);
+        } else {
+            if (m_maxAlternatives != 0) {
+                vosk_recognizer_set_max_alternatives(m_recognizer, 0);
+            }
+            m_pool->recycle(m_recognizer, m_fedSamples, std::move(m_grammar));
+        }
+        m_recognizer = nullptr;
+        m_fedSamples = 0;
+    }
+    m_grammar.clear();
+    m_speaker = false;
+    m_maxAlternatives = 0;
+    m_pool.reset();
+}
+
+void RecognitionSession::discard()
+{
+    if (m_recognizer) {
+        m_pool->discard(m_recognizer);
+        m_recognizer = nullptr;
+        m_fedSamples = 0;
+    }
+    release();
+}
+
+std::shared_ptr<RecognizerPool> RecognizerPool::create(VoskModel *model, float sampleRate, size_t maxIdle)
+{
+    if (!model) {
+        return nullptr;
+    }
+    return std::shared_ptr<RecognizerPool>(new RecognizerPool(model, sampleRate, maxIdle));
+}
+
+RecognizerPool::RecognizerPool(VoskModel *model, float sampleRate, size_t maxIdle)
+    : m_model(model)
+    , m_sampleRate(sampleRate)
+    , m_maxIdle(maxIdle)
+{
+}
+
+RecognizerPool::~RecognizerPool()
+{
+    // Sessions hold a reference to the pool, so none are outstanding here
+    for (const Idle &idle : m_idle) {
+        vosk_recognizer_free(idle.recognizer);
+    }
+    for (const Idle &idle : m_grammarIdle) {
+        vosk_recognizer_free(idle.recognizer);
+    }
+    vosk_model_free(m_model);
+}
+
+RecognitionSession RecognizerPool::acquire()
+{
+    VoskRecognizer *recognizer = nullptr;
+    int64_t fedSamples = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty()) {
+            recognizer = m_idle.back().recognizer;
+            fedSamples = m_idle.back().fedSamples;
+            m_idle.pop_back();
+        }
+        m_active++;
+    }
+
+    // Creating a decoder only reads the model, so it needs no lock
+    if (!recognizer) {
+        recognizer = vosk_recognizer_new(m_model, m_sampleRate);
+        if (!recognizer) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            return RecognitionSession();
+        }
+        vosk_recognizer_set_words(recognizer, 1);
+    }
+
+    return RecognitionSession(shared_from_this(), recognizer, fedSamples, std::string());
+}
+
+RecognitionSession RecognizerPool::acquire(const std::string &grammar)
+{
+    if (grammar.empty()) {
+        return acquire();
+    }
+
+    VoskRecognizer *recognizer = nullptr;
+    int64_t fedSamples = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_grammarIdle.rbegin(); it != m_grammarIdle.rend(); ++it) {
+            if (it->grammar == grammar) {
+                recognizer = it->recognizer;
+                fedSamples = it->fedSamples;
+                m_grammarIdle.erase(std::next(it).base());
+                break;
+            }
+        }
+        m_active++;
+    }
+
+    // Compiles the grammar into a small decoding graph; this is the slow part
+    if (!recognizer) {
+        recognizer = vosk_recognizer_new_grm(m_model, m_sampleRate, grammar.c_str());
+        if (!recognizer) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_active--;
+            return RecognitionSession();
+        }
+        vosk_recognizer_set_words(recognizer, 1);
+    }
+
+    return RecognitionSession(shared_from_this(), recognizer, fedSamples, grammar);
+}
+
+void RecognizerPool::recycle(VoskRecognizer *recognizer, int64_t fedSamples, std::string grammar)
+{
+    vosk_recognizer_reset(recognizer);
+
+    VoskRecognizer *evicted = recognizer;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_active--;
+        if (grammar.empty()) {
+            if (m_idle.size() < m_maxIdle) {
+                m_idle.push_back(Idle { recognizer, fedSamples, std::string() });
+                return;
+            }
+        } else {
+            // Keep one compiled recognizer per grammar, dropping the least
+            // recently used grammar when over the limit
+            bool duplicate = false;
+            for (const Idle &idle : m_grammarIdle) {
+                duplicate = duplicate || idle.grammar == grammar;
+            }
+            if (!duplicate) {
+                m_grammarIdle.push_back(Idle { recognizer, fedSamples, std::move(grammar) });
+                evicted = nullptr;
+                if (m_grammarIdle.size() > MAX_IDLE_GRAMMARS) {
+                    evicted = m_grammarIdle.front().recognizer;
+                    m_grammarIdle.erase(m_grammarIdle.begin());
+                }
+            }
+        }
+    }
+    if (evicted) {
+        vosk_recognizer_free(evicted);
+    }
+}
+
+void RecognizerPool::discard(VoskRecognizer *recognizer)
+{
+    vosk_recognizer_free(recognizer);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active--;
+}
+
+size_t RecognizerPool::idleCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idle.size() + m_grammarIdle.size();
+}
+
+size_t RecognizerPool::activeCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active;
+}
@@ -0,0 +1,138 @@
+#ifndef RECOGNIZERPOOL_H
+#define RECOGNIZERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Forward declarations for Vosk types
+struct VoskModel;
+struct VoskRecognizer;
+struct VoskSpkModel;
+
+class RecognizerPool;
+
+// Exclusive use of one pooled VoskRecognizer. Move-only; the recognizer is
+// reset and handed back to its pool when the session is destroyed. A
+// session keeps its pool (and so the model) alive, so it may outlive the
+// owner that created the pool, e.g. a file job running across a model swap.
+class RecognitionSession
+{
+public:
+    RecognitionSession() = default;
+    ~RecognitionSession();
+
+    RecognitionSession(RecognitionSession &&other) noexcept;
+    RecognitionSession &operator=(RecognitionSession &&other) noexcept;
+    RecognitionSession(const RecognitionSession &) = delete;
+    RecognitionSession &operator=(const RecognitionSession &) = delete;
+
+    VoskRecognizer *recognizer() const { return m_recognizer; }
+    explicit operator bool() const { return m_recognizer != nullptr; }
+
+    const std::shared_ptr<RecognizerPool> &pool() const { return m_pool; }
+
+    // JSON phrase list the recognizer is constrained to; empty if none
+    const std::string &grammar() const { return m_grammar; }
+
+    // Makes final results carry the speaker's x-vector. Vosk can't detach
+    // a speaker model again, so such a recognizer is freed on release
+    // instead of going back to the pool. Call before feeding audio.
+    void setSpeakerModel(VoskSpkModel *model);
+
+    // N-best lists in final results; 0 for single best. Reset to 0 when
+    // the recognizer goes back to the pool, so other users get the
+    // default output.
+    void setMaxAlternatives(int count);
+
+    // vosk_recognizer_accept_waveform_s() that also counts the samples
+    int acceptWaveform(const int16_t *samples, int count);
+
+    // Samples fed since the recognizer was created. Vosk word times are
+    // measured on this clock; vosk_recognizer_reset() does not rewind it.
+    int64_t fedSamples() const { return m_fedSamples; }
+
+    // Returns the recognizer to the pool early
+    void release();
+
+    // Frees the recognizer instead of pooling it, e.g. after a long
+    // continuous session whose state should not be handed on
+    void discard();
+
+private:
+    friend class RecognizerPool;
+    RecognitionSession(std::shared_ptr<RecognizerPool> pool, VoskRecognizer *recognizer, int64_t fedSamples,
+                       std::string grammar);
+
+    std::shared_ptr<RecognizerPool> m_pool;
+    VoskRecognizer *m_recognizer = nullptr;
+    int64_t m_fedSamples = 0;
+    std::string m_grammar;
+    bool m_speaker = false;
+    int m_maxAlternatives = 0;
+};
+
+// One loaded VoskModel shared read-only by any number of recognizers.
+// acquire() hands out a recognizer from the idle list, or creates one, and
+// may be called from any thread; each session is then used by one thread at
+// a time. Model memory is paid once however many streams are decoded.
+//
+// Recognizers constrained to a grammar are pooled per grammar. Compiling a
+// grammar takes a while on large vocabularies, so the most recently used
+// grammars keep an idle recognizer and switching back to one is instant.
+class RecognizerPool : public std::enable_shared_from_this<RecognizerPool>
+{
+public:
+    // Takes ownership of the model; returns null if model is null
+    static std::shared_ptr<RecognizerPool> create(VoskModel *model, float sampleRate,
+                                                  size_t maxIdle = 4);
+    ~RecognizerPool();
+
+    RecognizerPool(const RecognizerPool &) = delete;
+    RecognizerPool &operator=(const RecognizerPool &) = delete;
+
+    // Empty session if Vosk could not create a recognizer
+    RecognitionSession acquire();
+
+    // Recognizer restricted to a JSON list of phrases, e.g.
+    // ["open settings", "go back", "[unk]"]. An empty grammar is the same
+    // as acquire(). Only models with a dynamic graph (most small models)
+    // support grammars; others decode unconstrained.
+    RecognitionSession acquire(const std::string &grammar);
+
+    VoskModel *model() const { return m_model; }
+    float sampleRate() const { return m_sampleRate; }
+
+    size_t idleCount() const;
+    size_t activeCount() const;
+
+private:
+    friend class RecognitionSession;
+    RecognizerPool(VoskModel *model, float sampleRate, size_t maxIdle);
+
+    struct Idle
+    {
+        VoskRecognizer *recognizer;
+        int64_t fedSamples;
+        std::string grammar;
+    };
+
+    void recycle(VoskRecognizer *recognizer, int64_t fedSamples, std::string grammar);
+    void discard(VoskRecognizer *recognizer);
+
+    VoskModel *m_model = nullptr;
+    const float m_sampleRate;
+    const size_t m_maxIdle;
+
+    mutable std::mutex m_mutex;
+    std::vector<Idle> m_idle;        // unconstrained, most recent last
+    std::vector<Idle> m_grammarIdle; // one per grammar, most recent last
+    size_t m_active = 0;
+
+    static constexpr size_t MAX_IDLE_GRAMMARS = 8;
+};
+
+#endif // RECOGNIZERPOOL_H
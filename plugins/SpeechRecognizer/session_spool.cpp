@@ -0,0 +1,304 @@
+#include "session_spool.h"
+#include "transcript_segment.h"
+#include "transcript_spill.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const int SAMPLE_RATE = 16000;
+
+bool writeAll(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeHeader(int fd, int64_t dataBytes)
+{
+    char header[44];
+    std::memcpy(header, "RIFF", 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(36 + dataBytes), header + 4);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, header + 16);
+    qToLittleEndian<quint16>(1, header + 20); // PCM
+    qToLittleEndian<quint16>(1, header + 22); // mono
+    qToLittleEndian<quint32>(SAMPLE_RATE, header + 24);
+    qToLittleEndian<quint32>(SAMPLE_RATE * 2, header + 28);
+    qToLittleEndian<quint16>(2, header + 32);
+    qToLittleEndian<quint16>(16, header + 34);
+    std::memcpy(header + 36, "data", 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(dataBytes), header + 40);
+    return ::pwrite(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+}
+
+} // namespace
+
+SessionSpool::SessionSpool(size_t ringCapacity)
+    : m_ring(ringCapacity)
+    , m_scratch(SAMPLE_RATE / 2)
+{
+}
+
+SessionSpool::~SessionSpool()
+{
+    close(LeaveInterrupted);
+}
+
+bool SessionSpool::open(const QString &directory, QString *error)
+{
+    close();
+
+    if (!QDir().mkpath(directory)) {
+        if (error) {
+            *error = "Cannot create " + directory;
+        }
+        return false;
+    }
+
+    m_directory = directory;
+    const QByteArray audioPath = QFile::encodeName(SessionSpool::audioPath(directory));
+    const QByteArray segmentsPath = QFile::encodeName(SessionSpool::segmentsPath(directory));
+    m_audioFd = ::open(audioPath.constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    m_segmentsFd = ::open(segmentsPath.constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_audioFd < 0 || m_segmentsFd < 0 || !writeHeader(m_audioFd, 0)) {
+        if (error) {
+            *error = QString("Cannot write to %1: %2").arg(directory, QString::fromLocal8Bit(std::strerror(errno)));
+        }
+        finish(Remove);
+        m_directory.clear();
+        return false;
+    }
+
+    m_dataBytes = 0;
+    m_syncedBytes = 0;
+    m_failed = false;
+    m_stopping = false;
+    m_closeAction = MarkClosed;
+    m_pendingLines.clear();
+    m_ring.discard();
+    m_thread = std::thread(&SessionSpool::run, this);
+    return true;
+}
+
+void SessionSpool::close(CloseAction action)
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_closeAction = action;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_directory.clear();
+}
+
+void SessionSpool::pushAudio(const int16_t *samples, size_t count)
+{
+    m_ring.push(samples, count);
+}
+
+void SessionSpool::appendSegment(const TranscriptSegment &segment)
+{
+    QByteArray line = TranscriptSpill::encode(segment);
+    line += '\n';
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingLines.push_back(std::move(line));
+}
+
+QVector<TranscriptSegment> SessionSpool::segments(const QString &directory)
+{
+    QVector<TranscriptSegment> segments;
+    QFile file(segmentsPath(directory));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return segments;
+    }
+    while (!file.atEnd()) {
+        TranscriptSegment segment;
+        if (TranscriptSpill::decode(file.readLine().trimmed(), &segment)) {
+            segments.append(segment);
+        }
+    }
+    return segments;
+}
+
+QStringList SessionSpool::interrupted(const QString &root)
+{
+    return list(root, false);
+}
+
+QStringList SessionSpool::closed(const QString &root)
+{
+    return list(root, true);
+}
+
+QStringList SessionSpool::list(const QString &root, bool closed)
+{
+    QStringList directories;
+    const QDir dir(root);
+    for (const QFileInfo &entry : dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        const QString path = entry.absoluteFilePath();
+        if (QFileInfo::exists(path + "/closed") == closed && QFileInfo::exists(audioPath(path))) {
+            directories << path;
+        }
+    }
+    return directories;
+}
+
+void SessionSpool::run()
+{
+    // Producers don't signal; the thread wakes once per sync interval and
+    // writes whatever accumulated, which keeps the capture path lock-free
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(SYNC_INTERVAL_MS), [this]() { return m_stopping; });
+        const bool stopping = m_stopping;
+        if (stopping && m_closeAction == Remove) {
+            // No point writing and syncing what is about to be deleted
+            break;
+        }
+        std::vector<QByteArray> lines;
+        lines.swap(m_pendingLines);
+        lock.unlock();
+
+        size_t count;
+        while ((count = m_ring.pop(m_scratch.data(), m_scratch.size())) > 0) {
+            if (!m_failed && !writeAudio(m_scratch.data(), count)) {
+                qWarning() << "Session spool: audio write failed:" << std::strerror(errno);
+                m_failed = true;
+            }
+        }
+        for (const QByteArray &line : lines) {
+            if (!m_failed && !writeAll(m_segmentsFd, line.constData(), static_cast<size_t>(line.size()))) {
+                qWarning() << "Session spool: segment write failed:" << std::strerror(errno);
+                m_failed = true;
+            }
+        }
+        if (!m_failed && !sync()) {
+            qWarning() << "Session spool: sync failed:" << std::strerror(errno);
+            m_failed = true;
+        }
+
+        lock.lock();
+        if (stopping) {
+            break;
+        }
+    }
+    const CloseAction action = m_closeAction;
+    lock.unlock();
+    finish(action);
+}
+
+bool SessionSpool::writeAudio(const int16_t *samples, size_t count)
+{
+    const char *data = reinterpret_cast<const char *>(samples);
+    size_t remaining = count * sizeof(int16_t);
+    while (remaining > 0) {
+        const int64_t position = HEADER_BYTES + m_dataBytes;
+        if (!m_window || position >= m_windowOffset + WINDOW_BYTES) {
+            if (!mapWindow(position - position % WINDOW_BYTES)) {
+                return false;
+            }
+        }
+        const size_t room = static_cast<size_t>(m_windowOffset + WINDOW_BYTES - position);
+        const size_t n = std::min(room, remaining);
+        std::memcpy(m_window + (position - m_windowOffset), data, n);
+        data += n;
+        remaining -= n;
+        m_dataBytes += static_cast<int64_t>(n);
+    }
+    return true;
+}
+
+bool SessionSpool::mapWindow(int64_t offset)
+{
+    unmapWindow();
+
+    // The file grows a window at a time; close() trims the unused tail
+    if (::ftruncate(m_audioFd, offset + WINDOW_BYTES) != 0) {
+        return false;
+    }
+    void *window = ::mmap(nullptr, WINDOW_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, m_audioFd, offset);
+    if (window == MAP_FAILED) {
+        return false;
+    }
+    m_window = static_cast<char *>(window);
+    m_windowOffset = offset;
+    return true;
+}
+
+void SessionSpool::unmapWindow()
+{
+    // Dirty pages stay in the page cache and are written by the next sync
+    if (m_window) {
+        ::munmap(m_window, WINDOW_BYTES);
+        m_window = nullptr;
+    }
+}
+
+bool SessionSpool::sync()
+{
+    // Samples first, then the header that makes them part of the WAV
+    if (m_dataBytes != m_syncedBytes) {
+        if (m_window && ::msync(m_window, WINDOW_BYTES, MS_SYNC) != 0) {
+            return false;
+        }
+        if (::fdatasync(m_audioFd) != 0 || !writeHeader(m_audioFd, m_dataBytes) || ::fdatasync(m_audioFd) != 0) {
+            return false;
+        }
+        m_syncedBytes = m_dataBytes;
+    }
+    return ::fdatasync(m_segmentsFd) == 0;
+}
+
+void SessionSpool::finish(CloseAction action)
+{
+    unmapWindow();
+    if (m_audioFd >= 0) {
+        if (action != Remove && ::ftruncate(m_audioFd, HEADER_BYTES + m_syncedBytes) != 0) {
+            qWarning() << "Session spool: cannot trim" << audioPath(m_directory);
+        }
+        ::close(m_audioFd);
+        m_audioFd = -1;
+    }
+    if (m_segmentsFd >= 0) {
+        ::close(m_segmentsFd);
+        m_segmentsFd = -1;
+    }
+    if (m_directory.isEmpty()) {
+        return;
+    }
+
+    if (action == Remove) {
+        QDir(m_directory).removeRecursively();
+    } else if (action == MarkClosed) {
+        QFile marker(m_directory + "/closed");
+        marker.open(QIODevice::WriteOnly);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef SESSIONSPOOL_H
+#define SESSIONSPOOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "aligned_buffer.h"
+#include "audio_ring_buffer.h"
+
+struct TranscriptSegment;
+
+// Crash-safe copy of one recording on disk, so audio and text survive the
+// app being killed mid-session. A spool is a directory holding:
+//   audio.wav       16 kHz mono s16le, appended through a memory-mapped
+//                   window; the RIFF sizes are only advanced after the
+//                   samples they cover are synced, so the file is a valid
+//                   WAV of everything durable at any point
+//   segments.jsonl  finalized segments, in TranscriptSpill's line format
+//   closed          written by close(MarkClosed); its absence marks an
+//                   interrupted session
+//
+// Producers never touch the disk: pushAudio() copies into a lock-free
+// ring and appendSegment() queues a line. A background thread writes both
+// and syncs in batches every SYNC_INTERVAL_MS, so at most that much is
+// lost on a crash.
+class SessionSpool
+{
+public:
+    enum CloseAction {
+        MarkClosed,      // keep the files as a finished recording
+        Remove,          // delete the directory
+        LeaveInterrupted // keep it as interrupted(), to be recovered
+    };
+
+    explicit SessionSpool(size_t ringCapacity = 16000 * 16);
+    ~SessionSpool(); // closes with LeaveInterrupted
+
+    SessionSpool(const SessionSpool &) = delete;
+    SessionSpool &operator=(const SessionSpool &) = delete;
+
+    // Creates |directory| and starts the I/O thread
+    bool open(const QString &directory, QString *error = nullptr);
+
+    // Writes and syncs everything queued (unless it is to be removed),
+    // stops the I/O thread and then applies |action|. Blocks until the I/O
+    // thread is done, so the GUI thread leaves it to a worker.
+    void close(CloseAction action = MarkClosed);
+
+    bool isOpen() const { return m_thread.joinable(); }
+    QString directory() const { return m_directory; }
+
+    // Capture thread; never blocks. Samples that don't fit while the disk
+    // is stalled are dropped and counted.
+    void pushAudio(const int16_t *samples, size_t count);
+    uint64_t droppedSamples() const { return m_ring.overrunSamples(); }
+
+    // Any thread
+    void appendSegment(const TranscriptSegment &segment);
+
+    static QString audioPath(const QString &directory) { return directory + "/audio.wav"; }
+    static QString segmentsPath(const QString &directory) { return directory + "/segments.jsonl"; }
+
+    // Segments spooled in |directory|, in order; a torn last line is skipped
+    static QVector<TranscriptSegment> segments(const QString &directory);
+
+    // Spool directories under |root| that were never closed, or that were
+    // closed with MarkClosed, oldest first
+    static QStringList interrupted(const QString &root);
+    static QStringList closed(const QString &root);
+
+    static constexpr int SYNC_INTERVAL_MS = 2000;
+
+private:
+    static QStringList list(const QString &root, bool closed);
+    void run();
+    bool writeAudio(const int16_t *samples, size_t count);
+    bool mapWindow(int64_t offset);
+    void unmapWindow();
+    bool sync();
+    void finish(CloseAction action);
+
+    QString m_directory;
+    AudioRingBuffer m_ring;
+    AlignedBuffer<int16_t> m_scratch;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    CloseAction m_closeAction = MarkClosed;
+    std::vector<QByteArray> m_pendingLines;
+
+    // Owned by the I/O thread while it runs
+    int m_audioFd = -1;
+    int m_segmentsFd = -1;
+    char *m_window = nullptr;
+    int64_t m_windowOffset = 0; // file offset of m_window, page aligned
+    int64_t m_dataBytes = 0;    // audio bytes written after the header
+    int64_t m_syncedBytes = 0;  // audio bytes covered by the header
+    std::atomic<bool> m_failed{false};
+
+    static constexpr int64_t HEADER_BYTES = 44;
+    static constexpr int64_t WINDOW_BYTES = 4 * 1024 * 1024; // ~2 min of audio
+};
+
+#endif // SESSIONSPOOL_H
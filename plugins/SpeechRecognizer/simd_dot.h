@@ -0,0 +1,136 @@
+#ifndef SIMDDOT_H
+#define SIMDDOT_H
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define STT_SIMD_SSE 1
+#if defined(__SSE2__) || defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define STT_SIMD_SSE2 1
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define STT_SIMD_NEON 1
+#endif
+
+// Dot product of two float arrays, vectorised four lanes at a time with
+// SSE (x86) or NEON (arm64). |count| need not be a multiple of four.
+inline float simdDot(const float *a, const float *b, int count)
+{
+    int i = 0;
+    float sum = 0.0f;
+
+#if defined(STT_SIMD_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(STT_SIMD_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= count; i += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Sum of squares of 16-bit samples, eight lanes at a time with SSE2 or
+// NEON. Accumulates in 64 bits, so any |count| of full-scale audio fits.
+inline int64_t simdSumSquares(const int16_t *samples, int count)
+{
+    int i = 0;
+    int64_t sum = 0;
+
+#if defined(STT_SIMD_SSE2)
+    // Each madd lane is at most 2 * 32768^2 = 2^31: exact as unsigned 32-bit
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+        const __m128i squares = _mm_madd_epi16(x, x);
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(squares, zero));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(squares, zero));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi64(acc0, acc1));
+    sum = lanes[0] + lanes[1];
+#elif defined(STT_SIMD_NEON)
+    int64x2_t acc0 = vdupq_n_s64(0);
+    int64x2_t acc1 = vdupq_n_s64(0);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(samples + i);
+        acc0 = vpadalq_s32(acc0, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+        acc1 = vpadalq_s32(acc1, vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+    }
+    const int64x2_t acc = vaddq_s64(acc0, acc1);
+    sum = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+#endif
+
+    for (; i < count; ++i) {
+        sum += static_cast<int32_t>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+// Number of adjacent sample pairs whose signs differ (zero counts as
+// positive), eight pairs at a time with SSE2 or NEON. |count| must stay
+// below 8 * 65536 so the 16-bit lane counters can't wrap.
+inline int simdSignChanges(const int16_t *samples, int count)
+{
+    int i = 1;
+    int changes = 0;
+
+#if defined(STT_SIMD_SSE2)
+    // The sign bit of a ^ b is set where the signs differ; an arithmetic
+    // shift turns it into -1, subtracted from the counters
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i - 1));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+        acc = _mm_sub_epi16(acc, _mm_srai_epi16(_mm_xor_si128(a, b), 15));
+    }
+    // Pairwise-add the eight counters into four 32-bit lanes
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_madd_epi16(acc, _mm_set1_epi16(1)));
+    changes = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(STT_SIMD_NEON)
+    uint16x8_t acc = vdupq_n_u16(0);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t a = vld1q_s16(samples + i - 1);
+        const int16x8_t b = vld1q_s16(samples + i);
+        acc = vaddq_u16(acc, vshrq_n_u16(vreinterpretq_u16_s16(veorq_s16(a, b)), 15));
+    }
+    const uint64x2_t wide = vpaddlq_u32(vpaddlq_u16(acc));
+    changes = static_cast<int>(vgetq_lane_u64(wide, 0) + vgetq_lane_u64(wide, 1));
+#endif
+
+    for (; i < count; ++i) {
+        changes += (samples[i - 1] < 0) != (samples[i] < 0);
+    }
+    return changes;
+}
+
+#endif // SIMDDOT_H
@@ -0,0 +1,174 @@
+#include "speaker_store.h"
+#include "simd_dot.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+#include <cmath>
+
+namespace {
+
+const quint32 FILE_MAGIC = 0x53504b31; // "SPK1"
+
+} // namespace
+
+bool SpeakerStore::enroll(const QString &name, const float *vector, int dimension)
+{
+    if (!vector || dimension <= 0 || (m_dimension != 0 && dimension != m_dimension)) {
+        return false;
+    }
+
+    // Normalize each utterance before summing so long enrollments don't
+    // outweigh short ones. A silent (zero) vector has no direction and must
+    // not create the name or fix the store's dimension.
+    const float norm = std::sqrt(simdDot(vector, vector, dimension));
+    if (!(norm > 0.0f)) {
+        return false;
+    }
+
+    m_dimension = dimension;
+    int index = m_names.indexOf(name);
+    if (index < 0) {
+        index = m_names.size();
+        m_names.append(name);
+        m_enrollments.push_back(0);
+        m_sums.resize(m_sums.size() + dimension, 0.0f);
+        m_rows.resize(m_rows.size() + dimension, 0.0f);
+    }
+
+    float *sum = m_sums.data() + static_cast<size_t>(index) * dimension;
+    for (int i = 0; i < dimension; ++i) {
+        sum[i] += vector[i] / norm;
+    }
+    m_enrollments[index]++;
+    updateRow(index);
+    return true;
+}
+
+bool SpeakerStore::remove(const QString &name)
+{
+    const int index = m_names.indexOf(name);
+    if (index < 0) {
+        return false;
+    }
+
+    const auto offset = static_cast<std::ptrdiff_t>(index) * m_dimension;
+    m_names.removeAt(index);
+    m_enrollments.erase(m_enrollments.begin() + index);
+    m_sums.erase(m_sums.begin() + offset, m_sums.begin() + offset + m_dimension);
+    m_rows.erase(m_rows.begin() + offset, m_rows.begin() + offset + m_dimension);
+    if (m_names.isEmpty()) {
+        m_dimension = 0;
+    }
+    return true;
+}
+
+void SpeakerStore::clear()
+{
+    m_dimension = 0;
+    m_names.clear();
+    m_enrollments.clear();
+    m_sums.clear();
+    m_rows.clear();
+}
+
+void SpeakerStore::updateRow(int index)
+{
+    const float *sum = m_sums.data() + static_cast<size_t>(index) * m_dimension;
+    float *row = m_rows.data() + static_cast<size_t>(index) * m_dimension;
+    const float norm = std::sqrt(simdDot(sum, sum, m_dimension));
+    for (int i = 0; i < m_dimension; ++i) {
+        row[i] = norm > 0.0f ? sum[i] / norm : 0.0f;
+    }
+}
+
+SpeakerStore::Match SpeakerStore::match(const float *vector, int dimension) const
+{
+    Match best;
+    if (!vector || dimension != m_dimension || m_names.isEmpty()) {
+        return best;
+    }
+
+    const float norm = std::sqrt(simdDot(vector, vector, dimension));
+    if (norm <= 0.0f) {
+        return best;
+    }
+
+    const float *row = m_rows.data();
+    for (int i = 0; i < m_names.size(); ++i, row += dimension) {
+        const float similarity = simdDot(row, vector, dimension) / norm;
+        if (best.index < 0 || similarity > best.similarity) {
+            best.index = i;
+            best.similarity = similarity;
+        }
+    }
+    return best;
+}
+
+bool SpeakerStore::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    qint32 dimension = 0;
+    qint32 count = 0;
+    in >> magic >> dimension >> count;
+    if (magic != FILE_MAGIC || dimension < 0 || count < 0 || (count > 0 && dimension == 0)) {
+        return false;
+    }
+
+    SpeakerStore store;
+    store.m_dimension = count > 0 ? dimension : 0;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        qint32 enrollments = 0;
+        in >> name >> enrollments;
+        store.m_names.append(name);
+        store.m_enrollments.push_back(enrollments);
+        for (qint32 k = 0; k < dimension; ++k) {
+            float value = 0.0f;
+            in >> value;
+            store.m_sums.push_back(value);
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    store.m_rows.resize(store.m_sums.size());
+    for (int i = 0; i < store.count(); ++i) {
+        store.updateRow(i);
+    }
+    *this = std::move(store);
+    return true;
+}
+
+bool SpeakerStore::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << FILE_MAGIC << qint32(m_dimension) << qint32(m_names.size());
+    for (int i = 0; i < m_names.size(); ++i) {
+        out << m_names[i] << qint32(m_enrollments[i]);
+        const float *sum = m_sums.data() + static_cast<size_t>(i) * m_dimension;
+        for (int k = 0; k < m_dimension; ++k) {
+            out << sum[k];
+        }
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
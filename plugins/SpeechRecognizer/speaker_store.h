@@ -0,0 +1,52 @@
+#ifndef SPEAKERSTORE_H
+#define SPEAKERSTORE_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+// Enrolled speakers for tagging utterances by voice. Each speaker is the
+// mean of the x-vectors Vosk returned for their enrollment utterances.
+// Means are kept normalized in one contiguous row-major array, so matching
+// is one SIMD dot product per speaker and cosine similarity needs no
+// division per row.
+class SpeakerStore
+{
+public:
+    struct Match
+    {
+        int index = -1;          // -1 if the store is empty
+        float similarity = 0.0f; // cosine, -1..1
+    };
+
+    SpeakerStore() = default;
+
+    int dimension() const { return m_dimension; }
+    int count() const { return m_names.size(); }
+    const QStringList &names() const { return m_names; }
+
+    // Adds one utterance's vector to the named speaker, creating it if
+    // new. False if the dimension differs from vectors already stored
+    // (i.e. they came from another speaker model).
+    bool enroll(const QString &name, const float *vector, int dimension);
+    bool remove(const QString &name);
+    void clear();
+
+    // Closest enrolled speaker by cosine similarity
+    Match match(const float *vector, int dimension) const;
+
+    bool load(const QString &path);
+    bool save(const QString &path) const;
+
+private:
+    void updateRow(int index);
+
+    int m_dimension = 0;
+    QStringList m_names;
+    std::vector<int> m_enrollments;
+    std::vector<float> m_sums; // count x dimension, unnormalized
+    std::vector<float> m_rows; // count x dimension, unit length
+};
+
+#endif // SPEAKERSTORE_H
@@ -1,17 +1,65 @@
 #include "speech_recognizer.h"
+#include "recognition_worker.h"
+#include "file_transcriber.h"
+#include "model_cache.h"
+#include "recognizer_pool.h"
 #include "vosk_api.h"
 
 #include <QDebug>
 #include <QStandardPaths>
 #include <QDir>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QFileInfo>
 #include <QAudioDeviceInfo>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QRunnable>
+
+#include <functional>
+
+namespace {
+
+// QRunnable::create() only exists from Qt 5.15
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(std::function<void()> function)
+        : m_function(std::move(function))
+    {
+    }
+
+    void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+
+TranscriptSegment shiftSegment(TranscriptSegment segment, qint64 ms)
+{
+    segment.startMs += ms;
+    segment.endMs += ms;
+    for (TranscriptWord &word : segment.words) {
+        word.startMs += ms;
+        word.endMs += ms;
+    }
+    return segment;
+}
+
+} // namespace
 
 SpeechRecognizer::SpeechRecognizer(QObject *parent)
     : QObject(parent)
+    , m_audioRing(RING_CAPACITY)
+    , m_transcript(new TranscriptModel(this))
 {
+    // Leave one core for live decoding
+    m_filePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    // Spools are closed one after another, off the GUI thread
+    m_spoolCloser.setMaxThreadCount(1);
+
+    // Room for one idle recognizer per file worker plus the live one
+    m_modelCache.reset(new ModelCache(static_cast<float>(SAMPLE_RATE),
+                                      static_cast<size_t>(m_filePool.maxThreadCount()) + 1));
+
     // Set up audio format for Vosk (16kHz, mono, 16-bit PCM)
     m_audioFormat.setSampleRate(SAMPLE_RATE);
     m_audioFormat.setChannelCount(CHANNELS);
@@ -20,38 +68,92 @@ SpeechRecognizer::SpeechRecognizer(QObject *parent)
     m_audioFormat.setByteOrder(QAudioFormat::LittleEndian);
     m_audioFormat.setSampleType(QAudioFormat::SignedInt);
 
-    // Set up process timer to handle audio data periodically
-    m_processTimer.setInterval(100); // Process every 100ms
-    connect(&m_processTimer, &QTimer::timeout, this, &SpeechRecognizer::processAudioData);
+    m_captureScratch.resize(CAPTURE_CHUNK_BYTES);
 
     // Set up duration timer
     m_durationTimer.setInterval(1000);
     connect(&m_durationTimer, &QTimer::timeout, this, &SpeechRecognizer::updateRecordingDuration);
 
+    // Decoding runs on its own thread so long utterances never block the UI
+    m_worker = new RecognitionWorker(&m_audioRing);
+    m_worker->moveToThread(&m_decodeThread);
+    connect(&m_decodeThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &RecognitionWorker::partialResult, this, &SpeechRecognizer::handlePartialResult);
+    connect(m_worker, &RecognitionWorker::finalResult, this, &SpeechRecognizer::handleFinalResult);
+    connect(m_worker, &RecognitionWorker::speechActiveChanged, this, &SpeechRecognizer::handleSpeechActive);
+    connect(m_worker, &RecognitionWorker::finished, this, &SpeechRecognizer::handleWorkerFinished);
+    connect(m_worker, &RecognitionWorker::modelSwitched, this, &SpeechRecognizer::handleModelSwitched);
+    connect(m_worker, &RecognitionWorker::grammarApplied, this, &SpeechRecognizer::handleGrammarApplied);
+    connect(m_worker, &RecognitionWorker::speakerModelApplied, this, &SpeechRecognizer::handleSpeakerModelApplied);
+    m_decodeThread.setObjectName("RecognitionWorker");
+    m_decodeThread.start();
+
     // Suppress Vosk debug output
     vosk_set_log_level(-1);
+    
+    m_speakers.load(speakerStorePath());
+    m_interruptedSessions = SessionSpool::interrupted(spoolRoot());
+    
+    // Kept audio belongs to a transcript that is gone with the last run
+    const QStringList stale = SessionSpool::closed(spoolRoot());
+    if (!stale.isEmpty()) {
+        m_filePool.start(new FunctionRunnable([stale]() {
+            for (const QString &directory : stale) {
+                QDir(directory).removeRecursively();
+            }
+        }));
+    }
 
     setStatus("Ready");
     
-    // Try to load model automatically
+    // Try to load model automatically, without blocking the first frame
     QString modelPath = findModelPath();
     if (!modelPath.isEmpty()) {
-        loadModel(modelPath);
+        loadModelAsync(modelPath);
     }
 }
 
 SpeechRecognizer::~SpeechRecognizer()
 {
+    m_cancelFileJobs = true;
+    m_cancelRedecode = true;
+    m_filePool.waitForDone();
+    m_spoolCloser.waitForDone();
+    if (m_redecoder) {
+        m_redecoder->wait();
+        delete m_redecoder;
+        m_redecoder = nullptr;
+    }
+    
     stopRecording();
     
-    if (m_recognizer) {
-        vosk_recognizer_free(m_recognizer);
-        m_recognizer = nullptr;
+    if (m_modelLoader) {
+        m_modelLoader->wait();
+        delete m_modelLoader;
+        m_modelLoader = nullptr;
+    }
+    if (m_modelPreloader) {
+        m_modelPreloader->wait();
+        delete m_modelPreloader;
+        m_modelPreloader = nullptr;
     }
+    m_pendingPool.reset();
     
-    if (m_model) {
-        vosk_model_free(m_model);
-        m_model = nullptr;
+    releaseModel();
+    m_modelCache->clear();
+    discardKeptSessions();
+    m_spoolCloser.waitForDone();
+    m_decodeThread.quit();
+    m_decodeThread.wait();
+    
+    // Recognizers hold their own reference, all of them are gone by now
+    for (VoskSpkModel *model : m_retiredSpeakerModels) {
+        vosk_spk_model_free(model);
+    }
+    m_retiredSpeakerModels.clear();
+    if (m_speakerModel) {
+        vosk_spk_model_free(m_speakerModel);
+        m_speakerModel = nullptr;
     }
 }
 
@@ -103,6 +205,11 @@ QString SpeechRecognizer::findModelPath()
 
 bool SpeechRecognizer::loadModel(const QString &modelPath)
 {
+    if (m_modelLoading) {
+        qDebug() << "Model load already in progress";
+        return false;
+    }
+    
     QString path = modelPath.isEmpty() ? findModelPath() : modelPath;
     
     if (path.isEmpty()) {
@@ -111,23 +218,96 @@ bool SpeechRecognizer::loadModel(const QString &modelPath)
         return false;
     }
     
+    m_modelDir = path;
+    m_loadingProfile = m_profile;
+    path = profiledModelPath(path);
+    
     setStatus("Loading model...");
     qDebug() << "Loading Vosk model from:" << path;
     
-    // Free existing model if any
-    if (m_recognizer) {
-        vosk_recognizer_free(m_recognizer);
-        m_recognizer = nullptr;
+    // The current model stays in use until the new one is ready
+    return installModel(m_modelCache->acquire(path), path);
+}
+
+bool SpeechRecognizer::loadModelAsync(const QString &modelPath)
+{
+    if (m_modelLoading) {
+        qDebug() << "Model load already in progress";
+        return false;
+    }
+    
+    QString path = modelPath.isEmpty() ? findModelPath() : modelPath;
+    
+    if (path.isEmpty()) {
+        emit errorOccurred("No speech recognition model found. Please install a Vosk model.");
+        emit modelLoadFailed("No model found");
+        setStatus("No model found");
+        return false;
     }
-    if (m_model) {
-        vosk_model_free(m_model);
-        m_model = nullptr;
+    
+    m_modelDir = path;
+    m_loadingProfile = m_profile;
+    path = profiledModelPath(path);
+    
+    // A resident model swaps in without touching the disk
+    if (std::shared_ptr<RecognizerPool> pool = m_modelCache->find(path)) {
+        qDebug() << "Using cached model for:" << path;
+        return installModel(pool, path);
     }
     
-    // Load the model
-    m_model = vosk_model_new(path.toUtf8().constData());
+    setStatus("Loading model...");
+    qDebug() << "Loading Vosk model in background from:" << path;
+    
+    m_modelLoading = true;
+    emit modelLoadingChanged();
+    m_modelLoadTimer.start();
+    
+    // vosk_model_new() can take seconds; run it off the GUI thread and pick
+    // the result up once the loader thread has finished
+    m_modelLoader = QThread::create([this, path]() {
+        m_pendingPool = m_modelCache->acquire(path);
+    });
+    m_modelLoader->setObjectName("ModelLoader");
+    connect(m_modelLoader, &QThread::finished, this, [this, path]() {
+        finishModelLoad(path);
+    });
+    m_modelLoader->start(QThread::LowPriority);
     
-    if (!m_model) {
+    return true;
+}
+
+void SpeechRecognizer::finishModelLoad(const QString &path)
+{
+    m_modelLoader->wait();
+    m_modelLoader->deleteLater();
+    m_modelLoader = nullptr;
+    
+    std::shared_ptr<RecognizerPool> pool = std::move(m_pendingPool);
+    
+    qDebug() << "Background model load took" << m_modelLoadTimer.elapsed() << "ms";
+    
+    // The previous model stayed usable while loading; a running session
+    // moves over at its next utterance boundary
+    if (pool) {
+        installModel(pool, path);
+        return;
+    }
+    
+    emit errorOccurred("Failed to load speech recognition model from: " + path);
+    setStatus("Model load failed");
+    m_modelLoading = false;
+    emit modelLoadingChanged();
+    if (!m_isModelLoaded) {
+        abandonStoppedRecording();
+    }
+    emit modelLoadFailed("Failed to load speech recognition model from: " + path);
+    reloadForProfileChange();
+}
+
+bool SpeechRecognizer::installModel(const std::shared_ptr<RecognizerPool> &pool, const QString &path)
+{
+    if (!pool) {
+        releaseModel();
         emit errorOccurred("Failed to load speech recognition model from: " + path);
         setStatus("Model load failed");
         m_isModelLoaded = false;
@@ -135,30 +315,773 @@ bool SpeechRecognizer::loadModel(const QString &modelPath)
         return false;
     }
     
-    // Create recognizer
-    m_recognizer = vosk_recognizer_new(m_model, static_cast<float>(SAMPLE_RATE));
+    // The recognizer is created on the decode thread, with the grammar
+    // compiled if one is set; handleModelSwitched() picks up from there.
+    // The VAD has to outlast the profile's longest endpoint silence, or
+    // that rule never fires.
+    m_installingPool = pool;
+    m_installingPath = path;
+    if (!m_modelLoading) {
+        m_modelLoading = true;
+        emit modelLoadingChanged();
+    }
+    const int hangoverMs = ModelProfile::vadHangoverMs(path);
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, pool, hangoverMs]() {
+        worker->setVadHangoverMs(hangoverMs);
+        worker->requestModel(pool);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SpeechRecognizer::handleModelSwitched(bool ok)
+{
+    std::shared_ptr<RecognizerPool> pool = std::move(m_installingPool);
+    const QString path = m_installingPath;
+    m_modelLoading = false;
+    emit modelLoadingChanged();
     
-    if (!m_recognizer) {
-        vosk_model_free(m_model);
-        m_model = nullptr;
+    // The decode thread keeps the previous recognizer, if any
+    if (!ok || !pool) {
         emit errorOccurred("Failed to create speech recognizer");
-        setStatus("Recognizer creation failed");
-        m_isModelLoaded = false;
-        emit isModelLoadedChanged();
-        return false;
+        if (!m_isModelLoaded) {
+            setStatus("Recognizer creation failed");
+            abandonStoppedRecording();
+        }
+        emit modelLoadFailed("Failed to create speech recognizer");
+        reloadForProfileChange();
+        return;
     }
     
-    // Enable word timing (optional, for better UX)
-    vosk_recognizer_set_words(m_recognizer, 1);
-    
+    const bool wasLoaded = m_isModelLoaded;
+    m_pool = pool;
     m_isModelLoaded = true;
     emit isModelLoadedChanged();
-    setStatus("Ready");
-    qDebug() << "Model loaded successfully";
+    setStatus(m_isRecording ? "Listening..." : m_finalizing ? "Finalizing..." : "Ready");
+    qDebug() << "Model loaded successfully from" << path;
+    
+    // The grammar carries over, but the new vocabulary may lack some words
+    QStringList unknown = m_grammar.unknownWords(pool->model());
+    if (!unknown.isEmpty()) {
+        emit errorOccurred("Command words not in the new model: " + unknown.join(", "));
+    }
+    
+    emit modelLoaded();
+    
+    // Audio captured while the first model was loading is waiting in the
+    // ring; if the user already stopped, flush it now so nothing is lost
+    if (!wasLoaded && !m_isRecording && (m_finalizing || m_audioRing.available() > 0)) {
+        m_worker->endSessionAt(m_audioRing.written());
+        QMetaObject::invokeMethod(m_worker, &RecognitionWorker::finish, Qt::QueuedConnection);
+    }
+    
+    recoverInterruptedSessions();
+    reloadForProfileChange();
+}
+
+void SpeechRecognizer::reloadForProfileChange()
+{
+    // setPerformanceProfile() during a load only records the profile; the
+    // model has to be loaded again once that load is done
+    if (m_loadingProfile != m_profile && !m_modelDir.isEmpty()) {
+        loadModelAsync(m_modelDir);
+    }
+}
+
+void SpeechRecognizer::abandonStoppedRecording()
+{
+    // Without a recognizer nothing will finish a recording stopped while
+    // the model was loading, so handleWorkerFinished() never runs; its
+    // spool is removed here, or the next start would recover it
+    if (m_isRecording) {
+        return;
+    }
+    setFinalizing(false);
+    closeSpool(true);
+}
+
+bool SpeechRecognizer::setGrammar(const QStringList &phrases)
+{
+    return applyGrammar(VoskGrammar::fromPhrases(phrases));
+}
+
+bool SpeechRecognizer::setGrammarJson(const QString &json)
+{
+    QString error;
+    VoskGrammar grammar = VoskGrammar::fromJson(json, &error);
+    if (!error.isEmpty()) {
+        emit errorOccurred("Invalid grammar: " + error);
+        return false;
+    }
+    return applyGrammar(grammar);
+}
+
+void SpeechRecognizer::clearGrammar()
+{
+    applyGrammar(VoskGrammar());
+}
+
+QStringList SpeechRecognizer::unknownWords(const QStringList &phrases) const
+{
+    return m_pool ? VoskGrammar::fromPhrases(phrases).unknownWords(m_pool->model()) : QStringList();
+}
+
+bool SpeechRecognizer::loadSpeakerModel(const QString &path)
+{
+    VoskSpkModel *model = vosk_spk_model_new(path.toUtf8().constData());
+    if (!model) {
+        emit errorOccurred("Failed to load speaker model from: " + path);
+        return false;
+    }
+    
+    // The old model is freed once the decode thread has moved off it
+    VoskSpkModel *previous = m_speakerModel;
+    m_speakerModel = model;
+    if (m_speakerIdEnabled) {
+        applySpeakerModel();
+    }
+    if (previous) {
+        m_retiredSpeakerModels.append(previous);
+        freeRetiredSpeakerModels();
+    } else {
+        emit speakerModelLoadedChanged();
+    }
+    qDebug() << "Speaker model loaded from:" << path;
+    return true;
+}
+
+void SpeechRecognizer::setMaxAlternatives(int count)
+{
+    count = qMax(0, count);
+    if (m_maxAlternatives == count) {
+        return;
+    }
+    m_maxAlternatives = count;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, count]() {
+        worker->setMaxAlternatives(count);
+    }, Qt::QueuedConnection);
+    emit maxAlternativesChanged();
+}
+
+void SpeechRecognizer::setSpeakerIdEnabled(bool enabled)
+{
+    if (m_speakerIdEnabled == enabled) {
+        return;
+    }
+    m_speakerIdEnabled = enabled;
+    applySpeakerModel();
+    emit speakerIdEnabledChanged();
+}
+
+void SpeechRecognizer::setSpeakerThreshold(qreal threshold)
+{
+    if (qFuzzyCompare(m_speakerThreshold, threshold)) {
+        return;
+    }
+    m_speakerThreshold = threshold;
+    emit speakerThresholdChanged();
+}
+
+void SpeechRecognizer::applySpeakerModel()
+{
+    // Attaching renews the recognizer, which may compile the grammar; the
+    // decode thread does it and reports back in handleSpeakerModelApplied()
+    VoskSpkModel *model = m_speakerIdEnabled ? m_speakerModel : nullptr;
+    m_requestedSpeakerModels.append(model);
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, model]() {
+        worker->requestSpeakerModel(model);
+    }, Qt::QueuedConnection);
+}
+
+void SpeechRecognizer::handleSpeakerModelApplied(bool ok)
+{
+    // Requests are answered in the order they were queued
+    VoskSpkModel *model = m_requestedSpeakerModels.takeFirst();
+    if (ok) {
+        m_appliedSpeakerModel = model;
+    } else {
+        emit errorOccurred("Failed to attach speaker model");
+    }
+    freeRetiredSpeakerModels();
+}
+
+void SpeechRecognizer::freeRetiredSpeakerModels()
+{
+    // Recognizers hold their own reference; only the worker's pointer for
+    // the next recognizer has to stay valid
+    for (int i = m_retiredSpeakerModels.size() - 1; i >= 0; --i) {
+        VoskSpkModel *model = m_retiredSpeakerModels.at(i);
+        if (model != m_appliedSpeakerModel && !m_requestedSpeakerModels.contains(model)) {
+            vosk_spk_model_free(model);
+            m_retiredSpeakerModels.remove(i);
+        }
+    }
+}
+
+bool SpeechRecognizer::enrollSpeaker(const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    if (trimmed.isEmpty()) {
+        return false;
+    }
+    if (m_lastSpeakerVector.isEmpty()) {
+        emit errorOccurred("No utterance to enroll yet. Enable speaker identification and say something first.");
+        return false;
+    }
+    if (!m_speakers.enroll(trimmed, m_lastSpeakerVector.constData(), m_lastSpeakerVector.size())) {
+        emit errorOccurred("Speaker vector does not match the enrolled speakers; was the speaker model changed?");
+        return false;
+    }
+    
+    QDir().mkpath(QFileInfo(speakerStorePath()).absolutePath());
+    if (!m_speakers.save(speakerStorePath())) {
+        qWarning() << "Could not save speaker enrollments to" << speakerStorePath();
+    }
+    emit speakersChanged();
+    return true;
+}
+
+bool SpeechRecognizer::removeSpeaker(const QString &name)
+{
+    if (!m_speakers.remove(name)) {
+        return false;
+    }
+    m_speakers.save(speakerStorePath());
+    emit speakersChanged();
+    return true;
+}
+
+QString SpeechRecognizer::speakerStorePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/speakers.dat";
+}
+
+bool SpeechRecognizer::openSpill()
+{
+    if (m_spill.isOpen()) {
+        return true;
+    }
+    
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+        + "/transcripts/" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".jsonl";
+    if (!m_spill.open(path)) {
+        emit errorOccurred("Could not write transcript file: " + m_spill.errorString());
+        return false;
+    }
+    
+    // Rows from before continuous mode was switched on come first
+    for (int row = 0; row < m_transcript->count(); ++row) {
+        m_spill.append(*m_transcript, row);
+    }
+    emit transcriptFileChanged();
+    return true;
+}
+
+bool SpeechRecognizer::applyGrammar(const VoskGrammar &grammar)
+{
+    if (grammar.phrases() == m_requestedGrammar.phrases()) {
+        return true;
+    }
+    
+    if (!grammar.isEmpty()) {
+        if (!m_pool) {
+            emit errorOccurred("Model not loaded. Please load a model first.");
+            return false;
+        }
+        QStringList unknown = grammar.unknownWords(m_pool->model());
+        if (!unknown.isEmpty()) {
+            emit errorOccurred("Command words not in the model: " + unknown.join(", "));
+            return false;
+        }
+    }
+    
+    // Compiling the graph can take a while; the decode thread does it and
+    // keeps the current grammar until the new one is ready
+    m_requestedGrammar = grammar;
+    const QString json = QString::fromStdString(grammar.toJson());
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, json]() {
+        worker->requestGrammar(json);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SpeechRecognizer::handleGrammarApplied(const QString &json, bool ok)
+{
+    const bool latest = json == QString::fromStdString(m_requestedGrammar.toJson());
+    if (!ok) {
+        emit errorOccurred("Failed to create a recognizer for the grammar");
+        if (latest) {
+            m_requestedGrammar = m_grammar;
+        }
+        return;
+    }
+    
+    // An earlier request that was superseded is still what the decoder
+    // uses until the later one is done
+    const VoskGrammar grammar = json.isEmpty() ? VoskGrammar() : VoskGrammar::fromJson(json);
+    if (grammar.phrases() == m_grammar.phrases()) {
+        return;
+    }
+    m_grammar = grammar;
+    emit grammarChanged();
+    qDebug() << "Grammar set:" << (grammar.isEmpty() ? QStringLiteral("unconstrained") : grammar.phrases().join(" | "));
+}
+
+void SpeechRecognizer::releaseRecognizer()
+{
+    if (!m_decodeThread.isRunning()) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_worker, [this]() {
+        m_worker->releaseRecognizer();
+    }, Qt::BlockingQueuedConnection);
+}
+
+QString SpeechRecognizer::spoolRoot() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/spool";
+}
+
+void SpeechRecognizer::recoverInterruptedSessions()
+{
+    // Found at startup; each runs once, like any file job, on the file pool
+    // so the UI stays responsive. Spooled segments are restored and only
+    // the audio after the last of them is decoded.
+    const QStringList sessions = m_interruptedSessions;
+    m_interruptedSessions.clear();
+    for (const QString &directory : sessions) {
+        qDebug() << "Recovering interrupted session" << directory;
+        const int jobId = queueFileJob(SessionSpool::audioPath(directory), directory);
+        if (jobId >= 0) {
+            m_recoveryJobs.insert(jobId, directory);
+        }
+    }
+}
+
+void SpeechRecognizer::finishRecovery(const QString &directory, const FileTranscription &result)
+{
+    if (!result.ok) {
+        // Left in place; tried again on the next start
+        qWarning() << "Could not recover" << directory << result.error;
+        return;
+    }
+    
+    for (const TranscriptSegment &segment : result.segments) {
+        m_recoveredSegments.append(segment);
+    }
+    m_recoveredMs += qRound64(result.audioSeconds * 1000.0);
+    appendRecoveredSegments();
+    emit sessionRecovered(result.text);
+    
+    // Deleting a long recording takes a moment; keep it off this thread
+    m_filePool.start(new FunctionRunnable([directory]() {
+        QDir(directory).removeRecursively();
+    }));
+}
+
+void SpeechRecognizer::appendRecoveredSegments()
+{
+    // Recovered rows go after whatever is in the transcript, but never
+    // between the rows of a recording in progress
+    if (m_isRecording || m_finalizing || m_recoveredSegments.isEmpty()) {
+        return;
+    }
+    
+    for (const TranscriptSegment &segment : m_recoveredSegments) {
+        appendSegment(shiftSegment(segment, m_recordedMs));
+    }
+    m_recordedMs += m_recoveredMs;
+    m_sessionOffsetMs = m_nextSessionOffsetMs = m_recordedMs;
+    m_recoveredSegments.clear();
+    m_recoveredMs = 0;
+    emit transcriptionChanged();
+}
+
+void SpeechRecognizer::closeSpool(bool discard)
+{
+    if (!m_spool) {
+        return;
+    }
+    
+    SessionSpool::CloseAction action = SessionSpool::Remove;
+    if (m_keepSessionAudio && !discard) {
+        KeptSession kept;
+        kept.directory = m_spool->directory();
+        kept.offsetMs = m_spoolOffsetMs;
+        kept.durationMs = m_spoolDurationMs;
+        m_keptSessions.append(kept);
+        emit keptSessionsChanged();
+        action = SessionSpool::MarkClosed;
+    }
+    
+    // Closing waits for the I/O thread's last writes and syncs (or the
+    // directory's removal); the UI doesn't
+    SessionSpool *spool = m_spool.release();
+    m_spoolCloser.start(new FunctionRunnable([spool, action]() {
+        spool->close(action);
+        delete spool;
+    }));
+}
+
+void SpeechRecognizer::discardKeptSessions()
+{
+    if (m_keptSessions.isEmpty()) {
+        return;
+    }
+    QStringList directories;
+    for (const KeptSession &kept : m_keptSessions) {
+        directories << kept.directory;
+    }
+    m_keptSessions.clear();
+    emit keptSessionsChanged();
+    
+    // After any close still writing to one of them
+    m_spoolCloser.start(new FunctionRunnable([directories]() {
+        for (const QString &directory : directories) {
+            QDir(directory).removeRecursively();
+        }
+    }));
+}
+
+void SpeechRecognizer::setKeepSessionAudio(bool enabled)
+{
+    if (m_keepSessionAudio == enabled) {
+        return;
+    }
+    // Applies to recordings closed from now on; already kept audio stays
+    m_keepSessionAudio = enabled;
+    emit keepSessionAudioChanged();
+}
+
+bool SpeechRecognizer::redecodeSessions(const QString &modelPath, const QString &profile)
+{
+    if (m_redecoder) {
+        qDebug() << "Re-decode already in progress";
+        return false;
+    }
+    if (m_keptSessions.isEmpty()) {
+        emit errorOccurred("No recorded audio to decode again. Enable keepSessionAudio before recording.");
+        return false;
+    }
+    ModelProfile::Profile decodeProfile;
+    if (!ModelProfile::fromName(profile, &decodeProfile)) {
+        emit errorOccurred("Unknown performance profile: " + profile);
+        return false;
+    }
+    const QString modelDir = modelPath.isEmpty() ? m_modelDir : modelPath;
+    if (modelDir.isEmpty()) {
+        emit errorOccurred("No speech recognition model found. Please install a Vosk model.");
+        return false;
+    }
+    const QString path = profiledModelPath(modelDir, decodeProfile);
     
+    m_cancelRedecode = false;
+    m_redecodeSession = -1;
+    const int generation = m_redecodeGeneration;
+    QStringList audioPaths;
+    for (const KeptSession &kept : m_keptSessions) {
+        audioPaths << SessionSpool::audioPath(kept.directory);
+    }
+    
+    qDebug() << "Re-decoding" << audioPaths.size() << "session(s) with" << path;
+    m_redecoder = QThread::create([this, path, audioPaths, generation]() {
+        // The last recording may still be finishing its file
+        m_spoolCloser.waitForDone();
+        
+        // Loading a large model can take a while; it happens here too
+        std::shared_ptr<RecognizerPool> pool = m_modelCache->acquire(path);
+        RecognitionSession session = pool ? pool->acquire() : RecognitionSession();
+        if (!session) {
+            QMetaObject::invokeMethod(this, [this, path]() {
+                emit errorOccurred("Failed to load model for re-decoding: " + path);
+                emit redecodeFinished(0, 0.0);
+            }, Qt::QueuedConnection);
+            return;
+        }
+        
+        FileTranscriber transcriber(std::move(session));
+        transcriber.setCancelFlag(&m_cancelRedecode);
+        int done = 0;
+        double audioSeconds = 0.0;
+        double processingSeconds = 0.0;
+        for (int i = 0; i < audioPaths.size(); ++i) {
+            transcriber.setSegmentCallback([this, generation, i](const TranscriptSegment &segment) {
+                QMetaObject::invokeMethod(this, [this, generation, i, segment]() {
+                    applyRedecodedSegment(generation, i, segment);
+                }, Qt::QueuedConnection);
+            });
+            
+            const FileTranscription result = transcriber.transcribe(audioPaths.at(i));
+            if (m_cancelRedecode.load()) {
+                break;
+            }
+            if (!result.ok) {
+                // The live text of that session stays as it is
+                qWarning() << "Re-decode failed:" << result.path << result.error;
+                continue;
+            }
+            QMetaObject::invokeMethod(this, [this, generation, i]() {
+                finishRedecodedSession(generation, i);
+            }, Qt::QueuedConnection);
+            done++;
+            audioSeconds += result.audioSeconds;
+            processingSeconds += result.processingSeconds;
+        }
+        
+        const qreal realTimeFactor = audioSeconds > 0.0 ? processingSeconds / audioSeconds : 0.0;
+        QMetaObject::invokeMethod(this, [this, done, realTimeFactor]() {
+            qDebug() << "Re-decoded" << done << "session(s), RTF" << realTimeFactor;
+            emit redecodeFinished(done, realTimeFactor);
+        }, Qt::QueuedConnection);
+    });
+    m_redecoder->setObjectName("Redecoder");
+    connect(m_redecoder, &QThread::finished, this, [this]() {
+        m_redecoder->deleteLater();
+        m_redecoder = nullptr;
+        emit redecodingChanged();
+    });
+    
+    // Below the decode thread, so live recording keeps real time
+    m_redecoder->start(QThread::LowPriority);
+    emit redecodingChanged();
     return true;
 }
 
+void SpeechRecognizer::cancelRedecode()
+{
+    // Segments already replaced stay; the rest keeps the live text
+    if (m_redecoder) {
+        m_cancelRedecode = true;
+    }
+}
+
+int SpeechRecognizer::rowAtOrAfter(qint64 ms) const
+{
+    int row = 0;
+    while (row < m_transcript->count() && m_transcript->segment(row).startMs < ms) {
+        row++;
+    }
+    return row;
+}
+
+void SpeechRecognizer::applyRedecodedSegment(int generation, int session, const TranscriptSegment &segment)
+{
+    if (generation != m_redecodeGeneration || session >= m_keptSessions.size()) {
+        return;
+    }
+    const KeptSession &kept = m_keptSessions.at(session);
+    const int evicted = m_transcript->evictedCount();
+    if (session != m_redecodeSession) {
+        m_redecodeSession = session;
+        m_redecodeRow = evicted + rowAtOrAfter(kept.offsetMs);
+    }
+    
+    // The new segment takes the place of every live row of this recording
+    // centred before its end; utterance boundaries rarely match exactly
+    TranscriptSegment shifted = shiftSegment(segment, kept.offsetMs);
+    const qint64 sessionEndMs = kept.offsetMs + kept.durationMs;
+    const int row = qMax(0, m_redecodeRow - evicted);
+    int count = 0;
+    while (row + count < m_transcript->count()) {
+        const TranscriptSegment &old = m_transcript->segment(row + count);
+        if (old.startMs >= sessionEndMs || (old.startMs + old.endMs) / 2 >= shifted.endMs) {
+            break;
+        }
+        count++;
+    }
+    if (count > 0) {
+        shifted.speaker = m_transcript->segment(row).speaker;
+    }
+    
+    m_transcript->replace(row, count, { shifted });
+    m_redecodeRow = evicted + row + 1;
+    emit transcriptionChanged();
+}
+
+void SpeechRecognizer::finishRedecodedSession(int generation, int session)
+{
+    if (generation != m_redecodeGeneration || session >= m_keptSessions.size()) {
+        return;
+    }
+    const KeptSession &kept = m_keptSessions.at(session);
+    const int evicted = m_transcript->evictedCount();
+    if (session != m_redecodeSession) {
+        m_redecodeRow = evicted + rowAtOrAfter(kept.offsetMs);
+    }
+    m_redecodeSession = -1;
+    
+    // Live rows the better decode found no speech in
+    const qint64 sessionEndMs = kept.offsetMs + kept.durationMs;
+    const int row = qMax(0, m_redecodeRow - evicted);
+    int count = 0;
+    while (row + count < m_transcript->count()
+           && m_transcript->segment(row + count).startMs < sessionEndMs) {
+        count++;
+    }
+    if (count > 0) {
+        m_transcript->replace(row, count, {});
+        emit transcriptionChanged();
+    }
+}
+
+QString SpeechRecognizer::profiledModelPath(const QString &modelDir)
+{
+    return profiledModelPath(modelDir, m_profile);
+}
+
+QString SpeechRecognizer::profiledModelPath(const QString &modelDir, ModelProfile::Profile profile)
+{
+    // Writes at most a few links and one small file
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/model-profiles";
+    QString error;
+    const QString path = ModelProfile::prepare(modelDir, profile, cacheDir, &error);
+    if (path.isEmpty()) {
+        qWarning() << "Profile" << ModelProfile::name(profile) << "not applied:" << error;
+        emit errorOccurred("Could not apply the " + ModelProfile::name(profile) + " profile: " + error);
+        return modelDir;
+    }
+    return path;
+}
+
+void SpeechRecognizer::releaseModel()
+{
+    // Running file jobs keep their own reference to the pool
+    releaseRecognizer();
+    m_pool.reset();
+}
+
+bool SpeechRecognizer::preloadModel(const QString &modelPath)
+{
+    if (modelPath.isEmpty() || m_modelPreloader) {
+        return false;
+    }
+    const QString path = profiledModelPath(modelPath);
+    if (m_modelCache->find(path)) {
+        return false;
+    }
+    
+    // Low priority so it never competes with live decoding; the result
+    // stays in the cache until loadModel()/loadModelAsync() asks for it
+    qDebug() << "Preloading Vosk model from:" << path;
+    m_modelPreloader = QThread::create([this, path]() {
+        ModelCache::prefetch(path);
+        m_modelCache->acquire(path);
+    });
+    m_modelPreloader->setObjectName("ModelPreloader");
+    connect(m_modelPreloader, &QThread::finished, this, [this]() {
+        m_modelPreloader->deleteLater();
+        m_modelPreloader = nullptr;
+    });
+    m_modelPreloader->start(QThread::IdlePriority);
+    
+    return true;
+}
+
+int SpeechRecognizer::transcribeFile(const QString &path)
+{
+    return queueFileJob(path, QString());
+}
+
+int SpeechRecognizer::queueFileJob(const QString &path, const QString &spoolDirectory)
+{
+    if (!m_pool) {
+        emit errorOccurred("Model not loaded. Please load a model first.");
+        return -1;
+    }
+    
+    const int jobId = m_nextFileJobId++;
+    m_activeFileTranscriptions++;
+    emit activeFileTranscriptionsChanged();
+    
+    // The session is taken when the job runs, so queued jobs don't hold
+    // recognizers; the captured pool keeps the model alive across a reload
+    m_filePool.start(new FunctionRunnable([this, jobId, path, spoolDirectory, pool = m_pool]() {
+        RecognitionSession session = pool->acquire();
+        if (!session) {
+            FileTranscription result;
+            result.path = path;
+            result.error = "Failed to create speech recognizer";
+            QMetaObject::invokeMethod(this, [this, jobId, result]() {
+                finishFileTranscription(jobId, result);
+            }, Qt::QueuedConnection);
+            return;
+        }
+        
+        FileTranscriber transcriber(std::move(session));
+        transcriber.setCancelFlag(&m_cancelFileJobs);
+        
+        // Report whole percents only, to keep the event queue quiet
+        int lastPercent = -1;
+        transcriber.setProgressCallback([this, jobId, &lastPercent](double progress) {
+            int percent = static_cast<int>(progress * 100);
+            if (percent == lastPercent) {
+                return;
+            }
+            lastPercent = percent;
+            QMetaObject::invokeMethod(this, [this, jobId, progress]() {
+                emit fileTranscriptionProgress(jobId, progress);
+            }, Qt::QueuedConnection);
+        });
+        
+        // A recovered recording keeps what was finalized before the crash,
+        // speaker tags included; only the audio after it is decoded
+        QVector<TranscriptSegment> spooled;
+        if (!spoolDirectory.isEmpty()) {
+            spooled = SessionSpool::segments(spoolDirectory);
+            if (!spooled.isEmpty()) {
+                transcriber.setStartMs(spooled.last().endMs);
+            }
+        }
+        
+        FileTranscription result = transcriber.transcribe(path);
+        if (result.ok && !spooled.isEmpty()) {
+            QStringList utterances;
+            for (const TranscriptSegment &segment : spooled) {
+                utterances << segment.text;
+            }
+            result.utterances = utterances + result.utterances;
+            result.segments = spooled + result.segments;
+            result.text = result.utterances.join(' ');
+        }
+        QMetaObject::invokeMethod(this, [this, jobId, result]() {
+            finishFileTranscription(jobId, result);
+        }, Qt::QueuedConnection);
+    }));
+    
+    qDebug() << "Queued file transcription" << jobId << "for" << path;
+    return jobId;
+}
+
+void SpeechRecognizer::transcribeFiles(const QStringList &paths)
+{
+    for (const QString &path : paths) {
+        if (transcribeFile(path) < 0) {
+            break;
+        }
+    }
+}
+
+void SpeechRecognizer::finishFileTranscription(int jobId, const FileTranscription &result)
+{
+    m_activeFileTranscriptions--;
+    emit activeFileTranscriptionsChanged();
+    
+    // Recovery jobs are internal; they report through sessionRecovered()
+    if (m_recoveryJobs.contains(jobId)) {
+        finishRecovery(m_recoveryJobs.take(jobId), result);
+        return;
+    }
+    
+    if (!result.ok) {
+        qWarning() << "File transcription failed:" << result.path << result.error;
+        emit fileTranscriptionFailed(jobId, result.path, result.error);
+        return;
+    }
+    
+    qDebug() << "Transcribed" << result.path << result.audioSeconds << "s of audio in"
+             << result.processingSeconds << "s, RTF" << result.realTimeFactor;
+    emit fileTranscriptionFinished(jobId, result.path, result.text, result.realTimeFactor);
+}
+
 void SpeechRecognizer::initAudio()
 {
     // Clean up existing audio input
@@ -188,9 +1111,63 @@ void SpeechRecognizer::initAudio()
                  << "size=" << m_audioFormat.sampleSize();
     }
     
+    // Whatever the device gives us is converted to 16 kHz mono int16
+    if (!configureConverter()) {
+        emit errorOccurred("Unsupported audio capture format");
+        setStatus("Audio error");
+        return;
+    }
+    
     m_audioInput = new QAudioInput(inputDevice, m_audioFormat, this);
 }
 
+bool SpeechRecognizer::configureConverter()
+{
+    if (m_audioFormat.byteOrder() != QAudioFormat::LittleEndian) {
+        return false;
+    }
+    
+    AudioConverter::SampleFormat format;
+    const int size = m_audioFormat.sampleSize();
+    switch (m_audioFormat.sampleType()) {
+    case QAudioFormat::SignedInt:
+        if (size == 16) {
+            format = AudioConverter::SampleFormat::Int16;
+        } else if (size == 32) {
+            format = AudioConverter::SampleFormat::Int32;
+        } else {
+            return false;
+        }
+        break;
+    case QAudioFormat::UnSignedInt:
+        if (size != 8) {
+            return false;
+        }
+        format = AudioConverter::SampleFormat::UInt8;
+        break;
+    case QAudioFormat::Float:
+        if (size != 32) {
+            return false;
+        }
+        format = AudioConverter::SampleFormat::Float32;
+        break;
+    default:
+        return false;
+    }
+    
+    if (!m_converter.configure(m_audioFormat.sampleRate(), m_audioFormat.channelCount(),
+                               format, SAMPLE_RATE, CAPTURE_CHUNK_BYTES)) {
+        return false;
+    }
+    m_convertScratch.resize(m_converter.maxOutputSamples(CAPTURE_CHUNK_BYTES));
+    
+    if (!m_converter.isPassthrough()) {
+        qDebug() << "Converting capture audio from" << m_audioFormat.sampleRate() << "Hz,"
+                 << m_audioFormat.channelCount() << "channel(s) to" << SAMPLE_RATE << "Hz mono";
+    }
+    return true;
+}
+
 void SpeechRecognizer::startRecording()
 {
     if (m_isRecording) {
@@ -198,15 +1175,19 @@ void SpeechRecognizer::startRecording()
         return;
     }
     
-    if (!m_isModelLoaded) {
+    // While the model is still loading, audio is queued in the ring
+    // and decoded as soon as the recognizer is ready
+    if (!m_isModelLoaded && !m_modelLoading) {
         emit errorOccurred("Model not loaded. Please load a model first.");
         return;
     }
     
-    // Reset recognizer for new session
-    if (m_recognizer) {
-        vosk_recognizer_reset(m_recognizer);
-    }
+    // Reset recognizer for new session. The previous recording may still
+    // be finalizing; only audio captured before now is dropped.
+    const size_t sessionStart = m_audioRing.written();
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, sessionStart]() {
+        worker->resetAt(sessionStart);
+    }, Qt::QueuedConnection);
     
     initAudio();
     
@@ -215,11 +1196,6 @@ void SpeechRecognizer::startRecording()
         return;
     }
     
-    // Clear the buffer
-    m_audioBuffer.close();
-    m_audioBuffer.setData(QByteArray());
-    m_audioBuffer.open(QIODevice::ReadWrite);
-    
     // Start audio capture
     m_audioDevice = m_audioInput->start();
     
@@ -229,24 +1205,41 @@ void SpeechRecognizer::startRecording()
         return;
     }
     
+    // Audio goes to disk as well, so a crash loses at most a couple of
+    // seconds. The previous recording's spool, if it is still finalizing,
+    // is done with: its audio is complete and its text in memory.
+    closeSpool();
+    QString spoolError;
+    m_spool.reset(new SessionSpool);
+    if (!m_spool->open(spoolRoot() + "/" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz"),
+                       &spoolError)) {
+        qWarning() << "Recording without crash recovery:" << spoolError;
+        m_spool.reset();
+    }
+    
     // Connect to read audio data
-    connect(m_audioDevice, &QIODevice::readyRead, this, [this]() {
-        if (m_audioDevice) {
-            QByteArray data = m_audioDevice->readAll();
-            if (!data.isEmpty()) {
-                m_audioBuffer.write(data);
-            }
-        }
-    });
+    connect(m_audioDevice, &QIODevice::readyRead, this, &SpeechRecognizer::readAudioData);
+    QMetaObject::invokeMethod(m_worker, &RecognitionWorker::start, Qt::QueuedConnection);
     
     m_isRecording = true;
     m_recordingDuration = 0;
+    
+    // The previous recording's tail may still be on its way; its result
+    // keeps the old offset, this recording's results use the new one
+    m_nextSessionOffsetMs = m_recordedMs;
+    m_spoolOffsetMs = m_recordedMs;
+    if (!m_finalizing) {
+        m_sessionOffsetMs = m_nextSessionOffsetMs;
+    }
+    m_overrunSamples = static_cast<qint64>(m_audioRing.overrunSamples());
+    m_droppedSamples = 0;
+    m_lateSamples = 0;
     m_elapsedTimer.start();
-    m_processTimer.start();
     m_durationTimer.start();
     
     emit isRecordingChanged();
     emit recordingDurationChanged();
+    emit pipelineCountersChanged();
     setStatus("Listening...");
     
     qDebug() << "Recording started";
@@ -258,8 +1251,9 @@ void SpeechRecognizer::stopRecording()
         return;
     }
     
-    m_processTimer.stop();
     m_durationTimer.stop();
+    m_spoolDurationMs = m_elapsedTimer.elapsed();
+    m_recordedMs += m_spoolDurationMs;
     
     if (m_audioInput) {
         m_audioInput->stop();
@@ -269,121 +1263,352 @@ void SpeechRecognizer::stopRecording()
     
     m_audioDevice = nullptr;
     
-    // Process any remaining audio
-    if (m_audioBuffer.size() > 0) {
-        m_audioBuffer.seek(0);
-        QByteArray remainingData = m_audioBuffer.readAll();
-        if (!remainingData.isEmpty()) {
-            processBuffer(remainingData);
-        }
+    // Decoding the tail and the final result can take a while for a long
+    // last utterance; leave it to the decode thread and return right away.
+    // handleWorkerFinished() picks up when it is done. While the model is
+    // still loading, finishModelLoad() queues the flush instead.
+    m_stopTimer.start();
+    if (m_isModelLoaded) {
+        m_worker->endSessionAt(m_audioRing.written());
+        QMetaObject::invokeMethod(m_worker, &RecognitionWorker::finish, Qt::QueuedConnection);
     }
     
-    // Get final result
-    if (m_recognizer) {
-        const char *result = vosk_recognizer_final_result(m_recognizer);
-        if (result) {
-            QJsonDocument doc = QJsonDocument::fromJson(QByteArray(result));
-            QJsonObject obj = doc.object();
-            QString text = obj.value("text").toString().trimmed();
-            
-            if (!text.isEmpty()) {
-                if (!m_transcription.isEmpty()) {
-                    m_transcription += " ";
-                }
-                m_transcription += text;
-                emit transcriptionChanged();
-                emit finalResult(text);
-            }
-        }
-    }
-    
-    m_audioBuffer.close();
     m_isRecording = false;
     
     emit isRecordingChanged();
-    setStatus("Ready");
+    setFinalizing(true);
+    if (!m_isModelLoaded && !m_modelLoading) {
+        abandonStoppedRecording();
+    }
     
     qDebug() << "Recording stopped";
 }
 
+void SpeechRecognizer::handleWorkerFinished()
+{
+    m_sessionOffsetMs = m_nextSessionOffsetMs;
+    if (!m_finalizing) {
+        return;
+    }
+    
+    // Everything of the recording is in the transcript now
+    if (!m_isRecording) {
+        closeSpool();
+    }
+    
+    m_stopLatencyMs = static_cast<int>(m_stopTimer.elapsed());
+    emit stopLatencyMsChanged();
+    qDebug() << "Final result" << m_stopLatencyMs << "ms after stop";
+    setFinalizing(false);
+    
+    appendRecoveredSegments();
+}
+
+void SpeechRecognizer::setFinalizing(bool finalizing)
+{
+    if (m_finalizing == finalizing) {
+        return;
+    }
+    m_finalizing = finalizing;
+    emit finalizingChanged();
+    if (!m_isRecording) {
+        setStatus(finalizing ? "Finalizing..." : "Ready");
+    }
+}
+
 void SpeechRecognizer::clearTranscription()
 {
-    m_transcription.clear();
+    // The next segment starts a new transcript file
+    if (m_spill.isOpen()) {
+        m_spill.close();
+        emit transcriptFileChanged();
+    }
+    // Kept audio and any re-decode refer to the old transcript's timeline
+    cancelRedecode();
+    m_redecodeGeneration++;
+    discardKeptSessions();
+    m_transcript->clear();
+    m_recordedMs = 0;
+    m_sessionOffsetMs = 0;
+    m_nextSessionOffsetMs = 0;
     emit transcriptionChanged();
+    setPartial(QString(), QString());
 }
 
-void SpeechRecognizer::processAudioData()
+void SpeechRecognizer::readAudioData()
 {
-    if (!m_isRecording || !m_recognizer) {
+    if (!m_audioDevice) {
         return;
     }
     
-    // Read available data from buffer
-    qint64 currentPos = m_audioBuffer.pos();
-    m_audioBuffer.seek(0);
-    QByteArray data = m_audioBuffer.readAll();
+    const bool passthrough = m_converter.isPassthrough();
+    const bool block = m_overflowPolicy == Block;
     
-    if (data.isEmpty()) {
-        return;
+    // In passthrough mode only read whole samples; a trailing odd byte stays
+    // in the device. The converter carries partial frames itself.
+    qint64 pending = m_audioDevice->bytesAvailable();
+    if (passthrough) {
+        pending &= ~qint64(1);
     }
     
-    // Clear the buffer for new data
-    m_audioBuffer.close();
-    m_audioBuffer.setData(QByteArray());
-    m_audioBuffer.open(QIODevice::ReadWrite);
+    while (pending > 0) {
+        qint64 want = qMin<qint64>(pending, m_captureScratch.size());
+        
+        // Backpressure: audio that doesn't fit stays in the device until
+        // the next readyRead; once its buffer is full, capture stalls
+        if (block) {
+            const qint64 space = static_cast<qint64>(m_audioRing.space());
+            if (passthrough) {
+                want = qMin<qint64>(want, space * qint64(sizeof(int16_t)));
+            } else if (m_converter.maxOutputSamples(static_cast<int>(want)) > space) {
+                want = 0;
+            }
+            if (want <= 0) {
+                break;
+            }
+        }
+        
+        qint64 bytes = m_audioDevice->read(m_captureScratch.data(), want);
+        if (bytes <= 0) {
+            break;
+        }
+        pending -= bytes;
+        
+        const int16_t *samples;
+        size_t count;
+        if (passthrough) {
+            samples = reinterpret_cast<const int16_t *>(m_captureScratch.data());
+            count = static_cast<size_t>(bytes) / sizeof(int16_t);
+        } else {
+            samples = m_convertScratch.data();
+            count = static_cast<size_t>(m_converter.process(m_captureScratch.data(), static_cast<int>(bytes),
+                                                            m_convertScratch.data()));
+        }
+        m_audioRing.push(samples, count);
+        if (m_spool) {
+            m_spool->pushAudio(samples, count);
+        }
+    }
     
-    processBuffer(data);
+    m_worker->wake();
 }
 
-void SpeechRecognizer::processBuffer(const QByteArray &buffer)
+void SpeechRecognizer::handlePartialResult(const QString &stable, const QString &tail)
 {
-    if (!m_recognizer || buffer.isEmpty()) {
+    setPartial(stable, tail);
+    
+    if (!stable.isEmpty() && !tail.isEmpty()) {
+        emit partialResult(stable + ' ' + tail);
+    } else if (!stable.isEmpty() || !tail.isEmpty()) {
+        emit partialResult(stable + tail);
+    }
+}
+
+void SpeechRecognizer::handleFinalResult(const TranscriptSegment &segment)
+{
+    // Worker times restart with each recording; keep the transcript's
+    // timeline increasing across recordings
+    TranscriptSegment shifted = shiftSegment(segment, m_sessionOffsetMs);
+    
+    // Tag by voice; the vector is kept for a following enrollSpeaker()
+    if (!segment.speakerVector.isEmpty()) {
+        m_lastSpeakerVector = segment.speakerVector;
+        SpeakerStore::Match match = m_speakers.match(segment.speakerVector.constData(),
+                                                     segment.speakerVector.size());
+        if (match.index >= 0 && match.similarity >= m_speakerThreshold) {
+            shifted.speaker = m_speakers.names().at(match.index);
+        }
+    }
+
+    // Results still arriving from a recording that was finalizing when the
+    // current one started belong to an earlier, already closed spool.
+    // Recovery restores these, so they carry the speaker tag.
+    if (m_spool && m_sessionOffsetMs == m_nextSessionOffsetMs) {
+        TranscriptSegment spooled = segment;
+        spooled.speaker = shifted.speaker;
+        m_spool->appendSegment(spooled);
+    }
+    
+    appendSegment(shifted);
+    emit transcriptionChanged();
+    setPartial(QString(), QString());
+    emit finalResult(segment.text);
+}
+
+void SpeechRecognizer::appendSegment(const TranscriptSegment &segment)
+{
+    // After clearTranscription() the next file is opened lazily; rows are
+    // only evicted while they are safely on disk
+    if (m_continuousMode && !m_spill.isOpen() && openSpill()) {
+        m_transcript->setMaxRows(MAX_RESIDENT_SEGMENTS);
+    }
+    
+    // One new row; transcription is only joined when someone reads it
+    m_transcript->append(segment);
+    if (m_spill.isOpen() && !m_spill.append(*m_transcript, m_transcript->count() - 1)) {
+        emit errorOccurred("Could not write transcript file: " + m_spill.errorString());
+        m_transcript->setMaxRows(0);
+        m_spill.close();
+        emit transcriptFileChanged();
+    }
+}
+
+void SpeechRecognizer::handleSpeechActive(bool active)
+{
+    if (m_speechActive != active) {
+        m_speechActive = active;
+        emit speechActiveChanged();
+    }
+}
+
+void SpeechRecognizer::setOverflowPolicy(OverflowPolicy policy)
+{
+    if (m_overflowPolicy == policy) {
+        return;
+    }
+    m_overflowPolicy = policy;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, policy]() {
+        worker->setOverflowPolicy(static_cast<RecognitionWorker::OverflowPolicy>(policy));
+    }, Qt::QueuedConnection);
+    emit overflowPolicyChanged();
+}
+
+void SpeechRecognizer::setMaxBacklogMs(int ms)
+{
+    if (m_maxBacklogMs == ms) {
         return;
     }
+    m_maxBacklogMs = ms;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, ms]() {
+        worker->setMaxBacklogMs(ms);
+    }, Qt::QueuedConnection);
+    emit maxBacklogMsChanged();
+}
+
+void SpeechRecognizer::setPerformanceProfile(const QString &name)
+{
+    ModelProfile::Profile profile;
+    if (!ModelProfile::fromName(name, &profile)) {
+        emit errorOccurred("Unknown performance profile: " + name);
+        return;
+    }
+    if (m_profile == profile) {
+        return;
+    }
+    m_profile = profile;
+    emit performanceProfileChanged();
     
-    // Feed audio data to Vosk
-    int accepted = vosk_recognizer_accept_waveform(
-        m_recognizer, 
-        buffer.constData(), 
-        buffer.size()
-    );
+    // A load already running finishes with the old profile and is followed
+    // by another with this one; see reloadForProfileChange()
+    if (!m_modelDir.isEmpty() && !m_modelLoading) {
+        loadModelAsync(m_modelDir);
+    }
+}
+
+void SpeechRecognizer::setContinuousMode(bool enabled)
+{
+    if (m_continuousMode == enabled) {
+        return;
+    }
+    m_continuousMode = enabled;
     
-    if (accepted) {
-        // We have a complete utterance
-        const char *result = vosk_recognizer_result(m_recognizer);
-        if (result) {
-            QJsonDocument doc = QJsonDocument::fromJson(QByteArray(result));
-            QJsonObject obj = doc.object();
-            QString text = obj.value("text").toString().trimmed();
-            
-            if (!text.isEmpty()) {
-                if (!m_transcription.isEmpty()) {
-                    m_transcription += " ";
-                }
-                m_transcription += text;
-                emit transcriptionChanged();
-                emit finalResult(text);
-            }
+    const int lifetimeMs = enabled ? RECOGNIZER_LIFETIME_MS : 0;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, lifetimeMs]() {
+        worker->setRecognizerLifetimeMs(lifetimeMs);
+    }, Qt::QueuedConnection);
+    
+    // Turning it off keeps the file going so it stays a complete record,
+    // but nothing more is evicted
+    if (enabled) {
+        if (openSpill()) {
+            m_transcript->setMaxRows(MAX_RESIDENT_SEGMENTS);
         }
     } else {
-        // Get partial result for live feedback
-        const char *partial = vosk_recognizer_partial_result(m_recognizer);
-        if (partial) {
-            QJsonDocument doc = QJsonDocument::fromJson(QByteArray(partial));
-            QJsonObject obj = doc.object();
-            QString text = obj.value("partial").toString().trimmed();
-            
-            if (!text.isEmpty()) {
-                emit partialResult(text);
-            }
-        }
+        m_transcript->setMaxRows(0);
+    }
+    emit continuousModeChanged();
+}
+
+void SpeechRecognizer::setVadEnabled(bool enabled)
+{
+    if (m_vadEnabled == enabled) {
+        return;
+    }
+    m_vadEnabled = enabled;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, enabled]() {
+        worker->setVadEnabled(enabled);
+    }, Qt::QueuedConnection);
+    emit vadEnabledChanged();
+}
+
+void SpeechRecognizer::setVadEnergyThreshold(qreal dbfs)
+{
+    if (qFuzzyCompare(m_vadEnergyThreshold, dbfs)) {
+        return;
+    }
+    m_vadEnergyThreshold = dbfs;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, dbfs]() {
+        worker->setVadEnergyThreshold(static_cast<float>(dbfs));
+    }, Qt::QueuedConnection);
+    emit vadEnergyThresholdChanged();
+}
+
+void SpeechRecognizer::setVadZeroCrossingThreshold(qreal rate)
+{
+    if (qFuzzyCompare(m_vadZeroCrossingThreshold, rate)) {
+        return;
     }
+    m_vadZeroCrossingThreshold = rate;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, rate]() {
+        worker->setVadZeroCrossingThreshold(static_cast<float>(rate));
+    }, Qt::QueuedConnection);
+    emit vadZeroCrossingThresholdChanged();
 }
 
 void SpeechRecognizer::updateRecordingDuration()
 {
     m_recordingDuration = static_cast<int>(m_elapsedTimer.elapsed() / 1000);
     emit recordingDurationChanged();
+    
+    qint64 overruns = static_cast<qint64>(m_audioRing.overrunSamples());
+    if (overruns != m_overrunSamples) {
+        qWarning() << "Decoder fell behind, dropped" << (overruns - m_overrunSamples) << "samples";
+        m_overrunSamples = overruns;
+        emit overrunSamplesChanged();
+    }
+    
+    qint64 dropped = m_worker->droppedSamples();
+    qint64 late = m_worker->lateSamples();
+    if (dropped != m_droppedSamples || late != m_lateSamples) {
+        if (dropped != m_droppedSamples) {
+            qWarning() << "Decoder over budget, skipped" << (dropped - m_droppedSamples) << "samples";
+        }
+        m_droppedSamples = dropped;
+        m_lateSamples = late;
+        emit pipelineCountersChanged();
+    }
+    
+    // All atomics on the worker side, safe to sample from here
+    int chunkMs = m_worker->chunkSamples() * 1000 / SAMPLE_RATE;
+    int backlogMs = static_cast<int>(m_worker->backlogSamples() * 1000 / SAMPLE_RATE);
+    if (chunkMs != m_decodeChunkMs || backlogMs != m_decodeBacklogMs) {
+        m_decodeChunkMs = chunkMs;
+        m_decodeBacklogMs = backlogMs;
+        emit decodeSchedulingChanged();
+    }
+}
+
+void SpeechRecognizer::setPartial(const QString &stable, const QString &tail)
+{
+    // Separate notifications so QML only relayouts the part that changed
+    if (m_partialStable != stable) {
+        m_partialStable = stable;
+        emit partialStableChanged();
+    }
+    if (m_partialTail != tail) {
+        m_partialTail = tail;
+        emit partialTailChanged();
+    }
 }
 
 void SpeechRecognizer::setStatus(const QString &status)
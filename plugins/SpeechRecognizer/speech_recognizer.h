@@ -5,78 +5,407 @@
 #include <QAudioInput>
 #include <QAudioFormat>
 #include <QIODevice>
-#include <QBuffer>
+#include <QByteArray>
+#include <QStringList>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QHash>
 
-// Forward declarations for Vosk types
-struct VoskModel;
-struct VoskRecognizer;
+#include "aligned_buffer.h"
+#include "audio_converter.h"
+#include "audio_ring_buffer.h"
+#include "model_profile.h"
+#include "session_spool.h"
+#include "speaker_store.h"
+#include "transcript_model.h"
+#include "transcript_spill.h"
+#include "vosk_grammar.h"
+
+#include <atomic>
+#include <memory>
+
+class ModelCache;
+class RecognitionWorker;
+class RecognizerPool;
+struct VoskSpkModel;
+struct FileTranscription;
 
 class SpeechRecognizer : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isRecording READ isRecording NOTIFY isRecordingChanged)
+    Q_PROPERTY(bool finalizing READ finalizing NOTIFY finalizingChanged)
+    Q_PROPERTY(int stopLatencyMs READ stopLatencyMs NOTIFY stopLatencyMsChanged)
     Q_PROPERTY(bool isModelLoaded READ isModelLoaded NOTIFY isModelLoadedChanged)
+    Q_PROPERTY(bool modelLoading READ modelLoading NOTIFY modelLoadingChanged)
     Q_PROPERTY(QString transcription READ transcription NOTIFY transcriptionChanged)
+    Q_PROPERTY(TranscriptModel *transcript READ transcript CONSTANT)
+    Q_PROPERTY(QString partialStable READ partialStable NOTIFY partialStableChanged)
+    Q_PROPERTY(QString partialTail READ partialTail NOTIFY partialTailChanged)
     Q_PROPERTY(QString status READ status NOTIFY statusChanged)
     Q_PROPERTY(int recordingDuration READ recordingDuration NOTIFY recordingDurationChanged)
+    Q_PROPERTY(qint64 overrunSamples READ overrunSamples NOTIFY overrunSamplesChanged)
+    Q_PROPERTY(int decodeChunkMs READ decodeChunkMs NOTIFY decodeSchedulingChanged)
+    Q_PROPERTY(int decodeBacklogMs READ decodeBacklogMs NOTIFY decodeSchedulingChanged)
+    Q_PROPERTY(OverflowPolicy overflowPolicy READ overflowPolicy WRITE setOverflowPolicy NOTIFY overflowPolicyChanged)
+    Q_PROPERTY(int maxBacklogMs READ maxBacklogMs WRITE setMaxBacklogMs NOTIFY maxBacklogMsChanged)
+    Q_PROPERTY(qint64 droppedSamples READ droppedSamples NOTIFY pipelineCountersChanged)
+    Q_PROPERTY(qint64 lateSamples READ lateSamples NOTIFY pipelineCountersChanged)
+    Q_PROPERTY(bool speechActive READ speechActive NOTIFY speechActiveChanged)
+    Q_PROPERTY(QStringList grammar READ grammar NOTIFY grammarChanged)
+    Q_PROPERTY(int maxAlternatives READ maxAlternatives WRITE setMaxAlternatives NOTIFY maxAlternativesChanged)
+    Q_PROPERTY(bool speakerModelLoaded READ speakerModelLoaded NOTIFY speakerModelLoadedChanged)
+    Q_PROPERTY(bool speakerIdEnabled READ speakerIdEnabled WRITE setSpeakerIdEnabled NOTIFY speakerIdEnabledChanged)
+    Q_PROPERTY(qreal speakerThreshold READ speakerThreshold WRITE setSpeakerThreshold NOTIFY speakerThresholdChanged)
+    Q_PROPERTY(QStringList speakers READ speakers NOTIFY speakersChanged)
+    Q_PROPERTY(int activeFileTranscriptions READ activeFileTranscriptions NOTIFY activeFileTranscriptionsChanged)
+    Q_PROPERTY(QString performanceProfile READ performanceProfile WRITE setPerformanceProfile NOTIFY performanceProfileChanged)
+    Q_PROPERTY(QStringList performanceProfiles READ performanceProfiles CONSTANT)
+    Q_PROPERTY(bool continuousMode READ continuousMode WRITE setContinuousMode NOTIFY continuousModeChanged)
+    Q_PROPERTY(QString transcriptFile READ transcriptFile NOTIFY transcriptFileChanged)
+    Q_PROPERTY(bool keepSessionAudio READ keepSessionAudio WRITE setKeepSessionAudio NOTIFY keepSessionAudioChanged)
+    Q_PROPERTY(int keptSessions READ keptSessions NOTIFY keptSessionsChanged)
+    Q_PROPERTY(bool redecoding READ redecoding NOTIFY redecodingChanged)
+    Q_PROPERTY(bool vadEnabled READ vadEnabled WRITE setVadEnabled NOTIFY vadEnabledChanged)
+    Q_PROPERTY(qreal vadEnergyThreshold READ vadEnergyThreshold WRITE setVadEnergyThreshold NOTIFY vadEnergyThresholdChanged)
+    Q_PROPERTY(qreal vadZeroCrossingThreshold READ vadZeroCrossingThreshold WRITE setVadZeroCrossingThreshold NOTIFY vadZeroCrossingThresholdChanged)
 
 public:
+    // Mirrors RecognitionWorker::OverflowPolicy
+    enum OverflowPolicy {
+        Block,           // stop reading the audio device; nothing is dropped, results arrive late
+        DropOldest,      // skip the oldest audio beyond maxBacklogMs
+        DropSilenceFirst // skip silent chunks first, the oldest audio only at twice the budget
+    };
+    Q_ENUM(OverflowPolicy)
+
     explicit SpeechRecognizer(QObject *parent = nullptr);
     ~SpeechRecognizer();
 
     bool isRecording() const { return m_isRecording; }
+    // After stopRecording() the tail of the recording is still being decoded
+    // until its final result arrives; stopLatencyMs is how long that took
+    // last time, -1 before the first stop
+    bool finalizing() const { return m_finalizing; }
+    int stopLatencyMs() const { return m_stopLatencyMs; }
     bool isModelLoaded() const { return m_isModelLoaded; }
-    QString transcription() const { return m_transcription; }
+    bool modelLoading() const { return m_modelLoading; }
+    QString transcription() const { return m_transcript->text(); }
+    TranscriptModel *transcript() const { return m_transcript; }
+    QString partialStable() const { return m_partialStable; }
+    QString partialTail() const { return m_partialTail; }
     QString status() const { return m_status; }
     int recordingDuration() const { return m_recordingDuration; }
+    qint64 overrunSamples() const { return m_overrunSamples; }
+    int decodeChunkMs() const { return m_decodeChunkMs; }
+    int decodeBacklogMs() const { return m_decodeBacklogMs; }
+    OverflowPolicy overflowPolicy() const { return m_overflowPolicy; }
+    int maxBacklogMs() const { return m_maxBacklogMs; }
+    qint64 droppedSamples() const { return m_droppedSamples; }
+    qint64 lateSamples() const { return m_lateSamples; }
+    bool speechActive() const { return m_speechActive; }
+    QStringList grammar() const { return m_grammar.phrases(); }
+    int maxAlternatives() const { return m_maxAlternatives; }
+    bool speakerModelLoaded() const { return m_speakerModel != nullptr; }
+    bool speakerIdEnabled() const { return m_speakerIdEnabled; }
+    qreal speakerThreshold() const { return m_speakerThreshold; }
+    QStringList speakers() const { return m_speakers.names(); }
+    int activeFileTranscriptions() const { return m_activeFileTranscriptions; }
+    QString performanceProfile() const { return ModelProfile::name(m_profile); }
+    QStringList performanceProfiles() const { return ModelProfile::names(); }
+    bool continuousMode() const { return m_continuousMode; }
+    QString transcriptFile() const { return m_spill.isOpen() ? m_spill.path() : QString(); }
+    bool keepSessionAudio() const { return m_keepSessionAudio; }
+    int keptSessions() const { return m_keptSessions.size(); }
+    bool redecoding() const { return m_redecoder != nullptr; }
+    bool vadEnabled() const { return m_vadEnabled; }
+    qreal vadEnergyThreshold() const { return m_vadEnergyThreshold; }
+    qreal vadZeroCrossingThreshold() const { return m_vadZeroCrossingThreshold; }
+
+    void setOverflowPolicy(OverflowPolicy policy);
+    void setMaxBacklogMs(int ms);
+    // N-best lists per utterance for correction UIs, read through
+    // transcript.alternatives(row); 0 (default) decodes single best
+    void setMaxAlternatives(int count);
+    void setSpeakerIdEnabled(bool enabled);
+    void setSpeakerThreshold(qreal threshold);
+    // Decoder beam and endpoint settings for the current model, see
+    // ModelProfile. Changing it reloads the model in the background and
+    // switches at the next utterance boundary.
+    void setPerformanceProfile(const QString &profile);
+    // For dictation running for hours: segments are also written to
+    // transcriptFile and only the most recent ones stay in transcript, and
+    // the recognizer is renewed periodically at utterance boundaries
+    void setContinuousMode(bool enabled);
+    // Keeps each recording's audio (16 kHz mono WAV, ~115 MB an hour) until
+    // the transcript is cleared, for redecodeSessions()
+    void setKeepSessionAudio(bool enabled);
+    void setVadEnabled(bool enabled);
+    void setVadEnergyThreshold(qreal dbfs);
+    void setVadZeroCrossingThreshold(qreal rate);
 
     Q_INVOKABLE void startRecording();
     Q_INVOKABLE void stopRecording();
     Q_INVOKABLE void clearTranscription();
     Q_INVOKABLE bool loadModel(const QString &modelPath = QString());
+    Q_INVOKABLE bool loadModelAsync(const QString &modelPath = QString());
+
+    // Loads a model into the cache in the background without switching to
+    // it, so a later loadModel()/loadModelAsync() for it is instant
+    Q_INVOKABLE bool preloadModel(const QString &modelPath);
+
+    // Command mode: live recognition only produces the given phrases
+    // (plus "[unk]" if listed). Every word must be in the model's
+    // vocabulary; otherwise nothing changes and errorOccurred() names the
+    // unknown words. The graph is compiled on the decode thread while the
+    // current grammar stays in use; grammarChanged() follows once the new
+    // one is, a failure is reported by errorOccurred(). Compiled grammars
+    // are cached, so switching between command sets is instant after first
+    // use. Applies at the next utterance boundary while recording.
+    Q_INVOKABLE bool setGrammar(const QStringList &phrases);
+    Q_INVOKABLE bool setGrammarJson(const QString &json);
+    Q_INVOKABLE void clearGrammar();
+    Q_INVOKABLE QStringList unknownWords(const QStringList &phrases) const;
+
+    // Speaker identification: with a Vosk speaker model loaded and
+    // speakerIdEnabled set, each utterance is tagged with the closest
+    // enrolled speaker whose cosine similarity reaches speakerThreshold.
+    // enrollSpeaker() adds the last utterance's voice to |name|; more
+    // utterances give a more robust profile. Enrollments are kept on the
+    // device in the app data directory.
+    Q_INVOKABLE bool loadSpeakerModel(const QString &path);
+    Q_INVOKABLE bool enrollSpeaker(const QString &name);
+    Q_INVOKABLE bool removeSpeaker(const QString &name);
+
+    // Offline transcription of WAV/raw PCM files, decoded faster than real
+    // time on a thread pool; returns a job id or -1 on error
+    Q_INVOKABLE int transcribeFile(const QString &path);
+    Q_INVOKABLE void transcribeFiles(const QStringList &paths);
+
+    // Decodes the kept recordings again with another model and/or profile,
+    // typically a larger model or the accurate profile after a session
+    // decoded live with a small one. Runs on one low-priority thread, as
+    // fast as the CPU allows; each re-decoded segment replaces the rows it
+    // covers in transcript as soon as it is done. A running transcript
+    // file (continuous mode) keeps the live text.
+    Q_INVOKABLE bool redecodeSessions(const QString &modelPath = QString(),
+                                      const QString &profile = QStringLiteral("accurate"));
+    Q_INVOKABLE void cancelRedecode();
 
 signals:
     void isRecordingChanged();
+    void finalizingChanged();
+    void stopLatencyMsChanged();
     void isModelLoadedChanged();
+    void modelLoadingChanged();
+    void modelLoaded();
+    void modelLoadFailed(const QString &error);
     void transcriptionChanged();
+    void partialStableChanged();
+    void partialTailChanged();
     void statusChanged();
     void recordingDurationChanged();
+    void overrunSamplesChanged();
+    void decodeSchedulingChanged();
+    void overflowPolicyChanged();
+    void maxBacklogMsChanged();
+    void pipelineCountersChanged();
+    void speechActiveChanged();
+    void grammarChanged();
+    void maxAlternativesChanged();
+    void speakerModelLoadedChanged();
+    void speakerIdEnabledChanged();
+    void speakerThresholdChanged();
+    void speakersChanged();
+    void activeFileTranscriptionsChanged();
+    void performanceProfileChanged();
+    void continuousModeChanged();
+    void transcriptFileChanged();
+    void vadEnabledChanged();
+    void vadEnergyThresholdChanged();
+    void vadZeroCrossingThresholdChanged();
     void partialResult(const QString &text);
     void finalResult(const QString &text);
     void errorOccurred(const QString &error);
+    void fileTranscriptionProgress(int jobId, qreal progress);
+    void fileTranscriptionFinished(int jobId, const QString &path, const QString &text, qreal realTimeFactor);
+    void fileTranscriptionFailed(int jobId, const QString &path, const QString &error);
+    // A recording cut short by a crash was decoded again from its spool;
+    // its segments are appended to the transcript
+    void sessionRecovered(const QString &text);
+    void keepSessionAudioChanged();
+    void keptSessionsChanged();
+    void redecodingChanged();
+    void redecodeFinished(int sessions, qreal realTimeFactor);
 
 private slots:
-    void processAudioData();
+    void readAudioData();
     void updateRecordingDuration();
+    void handlePartialResult(const QString &stable, const QString &tail);
+    void handleFinalResult(const TranscriptSegment &segment);
+    void handleSpeechActive(bool active);
+    void handleWorkerFinished();
+    void handleModelSwitched(bool ok);
+    void handleGrammarApplied(const QString &grammar, bool ok);
+    void handleSpeakerModelApplied(bool ok);
 
 private:
     void initAudio();
-    void processBuffer(const QByteArray &buffer);
+    bool configureConverter();
+    void finishModelLoad(const QString &path);
+    bool installModel(const std::shared_ptr<RecognizerPool> &pool, const QString &path);
+    void releaseModel();
+    void reloadForProfileChange();
+    void abandonStoppedRecording();
+    void finishFileTranscription(int jobId, const FileTranscription &result);
+    // With |spoolDirectory| set the job recovers that interrupted recording
+    int queueFileJob(const QString &path, const QString &spoolDirectory);
+    void releaseRecognizer();
     QString findModelPath();
     void setStatus(const QString &status);
+    void setFinalizing(bool finalizing);
+    void setPartial(const QString &stable, const QString &tail);
+    bool applyGrammar(const VoskGrammar &grammar);
+    void applySpeakerModel();
+    void freeRetiredSpeakerModels();
+    QString speakerStorePath() const;
+    bool openSpill();
+    void appendSegment(const TranscriptSegment &segment);
+    QString spoolRoot() const;
+    void recoverInterruptedSessions();
+    void finishRecovery(const QString &directory, const FileTranscription &result);
+    void appendRecoveredSegments();
+    void closeSpool(bool discard = false);
+    void discardKeptSessions();
+    int rowAtOrAfter(qint64 ms) const;
+    void applyRedecodedSegment(int generation, int session, const TranscriptSegment &segment);
+    void finishRedecodedSession(int generation, int session);
+    QString profiledModelPath(const QString &modelDir);
+    QString profiledModelPath(const QString &modelDir, ModelProfile::Profile profile);
 
     // Audio components (Qt5 style)
     QAudioInput *m_audioInput = nullptr;
     QIODevice *m_audioDevice = nullptr;
-    QBuffer m_audioBuffer;
     QAudioFormat m_audioFormat;
 
-    // Vosk components
-    VoskModel *m_model = nullptr;
-    VoskRecognizer *m_recognizer = nullptr;
+    // Capture -> decode handoff; preallocated so recording never allocates
+    AudioRingBuffer m_audioRing;
+    AlignedBuffer<char> m_captureScratch;
+
+    // Device format -> 16 kHz mono int16, used when the device rejects that
+    AudioConverter m_converter;
+    AlignedBuffer<int16_t> m_convertScratch;
+
+    // Vosk components; the pool owns the model and hands one recognizer to
+    // the live session on m_decodeThread and one to each file job
+    std::shared_ptr<RecognizerPool> m_pool;
+    RecognitionWorker *m_worker = nullptr;
+    QThread m_decodeThread;
+
+    // Recently used models stay resident for instant switching
+    std::unique_ptr<ModelCache> m_modelCache;
+    QString m_modelDir; // as requested, before the profile is applied
+    ModelProfile::Profile m_profile = ModelProfile::Balanced;
+    ModelProfile::Profile m_loadingProfile = ModelProfile::Balanced; // of the latest loadModel*()
+
+    // Background model loading
+    QThread *m_modelLoader = nullptr;
+    QThread *m_modelPreloader = nullptr;
+    std::shared_ptr<RecognizerPool> m_pendingPool;
+    std::shared_ptr<RecognizerPool> m_installingPool; // until the decode thread has switched
+    QString m_installingPath;
+    QElapsedTimer m_modelLoadTimer;
+
+    // Offline file transcription; one pooled session per running job
+    QThreadPool m_filePool;
+    std::atomic<bool> m_cancelFileJobs{false};
+    int m_nextFileJobId = 1;
+    int m_activeFileTranscriptions = 0;
 
     // State
     bool m_isRecording = false;
+    bool m_finalizing = false;
+    QElapsedTimer m_stopTimer;
+    int m_stopLatencyMs = -1;
     bool m_isModelLoaded = false;
-    QString m_transcription;
+    bool m_modelLoading = false;
+    TranscriptModel *m_transcript = nullptr;
+    QString m_partialStable;
+    QString m_partialTail;
     QString m_status;
     int m_recordingDuration = 0;
+    qint64 m_recordedMs = 0;      // all recordings since the transcript was cleared
+    qint64 m_sessionOffsetMs = 0; // transcript time at which this recording began
+    qint64 m_nextSessionOffsetMs = 0; // takes over once a finalizing recording is done
+    qint64 m_overrunSamples = 0;
+    int m_decodeChunkMs = 0;
+    int m_decodeBacklogMs = 0;
+    qint64 m_droppedSamples = 0;
+    qint64 m_lateSamples = 0;
+
+    // Backpressure settings, mirrored on the decode thread
+    OverflowPolicy m_overflowPolicy = DropSilenceFirst;
+    int m_maxBacklogMs = 3000;
+    bool m_speechActive = false;
+    VoskGrammar m_grammar;          // what the decoder uses
+    VoskGrammar m_requestedGrammar; // latest setGrammar(), possibly still compiling
+    int m_maxAlternatives = 0;
+
+    // Speaker identification
+    VoskSpkModel *m_speakerModel = nullptr;
+    // The decode thread may still use a replaced model until it has
+    // acknowledged every request sent before the replacement
+    VoskSpkModel *m_appliedSpeakerModel = nullptr;     // what the decode thread uses
+    QVector<VoskSpkModel *> m_requestedSpeakerModels; // sent, not yet acknowledged
+    QVector<VoskSpkModel *> m_retiredSpeakerModels;
+    bool m_speakerIdEnabled = false;
+    qreal m_speakerThreshold = 0.5;
+    SpeakerStore m_speakers;
+    QVector<float> m_lastSpeakerVector;
+
+    // Continuous mode; the spill holds every segment since the transcript
+    // was last cleared once it is open
+    bool m_continuousMode = false;
+    TranscriptSpill m_spill;
+
+    // Crash recovery: the current recording on disk, and sessions found
+    // interrupted at startup until they have been decoded again
+    std::unique_ptr<SessionSpool> m_spool; // null when not recording to disk
+    QThreadPool m_spoolCloser;
+    QStringList m_interruptedSessions;
+    QHash<int, QString> m_recoveryJobs; // file job -> spool directory
+    QVector<TranscriptSegment> m_recoveredSegments;
+    qint64 m_recoveredMs = 0;
+
+    // Kept recordings and where they sit in the transcript
+    struct KeptSession
+    {
+        QString directory;
+        qint64 offsetMs = 0;
+        qint64 durationMs = 0;
+    };
+    bool m_keepSessionAudio = false;
+    QVector<KeptSession> m_keptSessions;
+    qint64 m_spoolOffsetMs = 0;
+    qint64 m_spoolDurationMs = 0;
+
+    // Re-decoding; results of an older generation (before a clear) are
+    // ignored. m_redecodeRow counts evicted rows too, so it survives
+    // eviction in continuous mode.
+    QThread *m_redecoder = nullptr;
+    std::atomic<bool> m_cancelRedecode{false};
+    int m_redecodeGeneration = 0;
+    int m_redecodeSession = -1;
+    int m_redecodeRow = 0;
+
+    // Voice activity detection settings, mirrored on the decode thread
+    bool m_vadEnabled = true;
+    qreal m_vadEnergyThreshold = -45.0;
+    qreal m_vadZeroCrossingThreshold = 0.25;
 
     // Timers
-    QTimer m_processTimer;
     QTimer m_durationTimer;
     QElapsedTimer m_elapsedTimer;
 
@@ -84,6 +413,10 @@ private:
     static constexpr int SAMPLE_RATE = 16000;
     static constexpr int CHANNELS = 1;
     static constexpr int SAMPLE_SIZE = 16;
+    static constexpr int RING_CAPACITY = SAMPLE_RATE * 16; // ~16 s of audio
+    static constexpr int CAPTURE_CHUNK_BYTES = 16384;
+    static constexpr int MAX_RESIDENT_SEGMENTS = 400;
+    static constexpr int RECOGNIZER_LIFETIME_MS = 10 * 60 * 1000;
 };
 
 #endif // SPEECHRECOGNIZER_H
@@ -0,0 +1,276 @@
+#include "transcript_model.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <iterator>
+
+TranscriptModel::TranscriptModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int TranscriptModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant TranscriptModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= count()) {
+        return QVariant();
+    }
+
+    const Row &row = m_rows[index.row()];
+    const TranscriptSegment &segment = row.segment;
+    switch (role) {
+    case Qt::DisplayRole:
+    case TextRole:
+        return segment.text;
+    case StartTimeRole:
+        return segment.startMs;
+    case EndTimeRole:
+        return segment.endMs;
+    case ConfidenceRole:
+        return segment.confidence;
+    case FirstWordRole:
+        return row.firstWord;
+    case WordCountRole:
+        return row.wordCount;
+    case SpeakerRole:
+        return segment.speaker;
+    case AlternativeCountRole:
+        return segment.alternativeCount;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> TranscriptModel::roleNames() const
+{
+    return {
+        { TextRole, "text" },
+        { StartTimeRole, "startTime" },
+        { EndTimeRole, "endTime" },
+        { ConfidenceRole, "confidence" },
+        { FirstWordRole, "firstWord" },
+        { WordCountRole, "wordCount" },
+        { SpeakerRole, "speaker" },
+        { AlternativeCountRole, "alternativeCount" },
+    };
+}
+
+void TranscriptModel::append(const TranscriptSegment &segment)
+{
+    if (m_maxRows > 0 && count() >= m_maxRows) {
+        evict(std::max(1, m_maxRows / 4));
+    }
+
+    Row row;
+    row.segment = segment;
+    row.segment.words.clear();
+    row.segment.speakerVector.clear();
+    row.firstWord = m_words.count();
+    row.wordCount = segment.words.size();
+    for (const TranscriptWord &word : segment.words) {
+        m_words.append(word.text, word.startMs, word.endMs, word.confidence);
+    }
+
+    const int index = count();
+    beginInsertRows(QModelIndex(), index, index);
+    m_rows.push_back(std::move(row));
+    endInsertRows();
+    emit countChanged();
+}
+
+void TranscriptModel::replace(int row, int count, const QVector<TranscriptSegment> &segments)
+{
+    row = std::min(std::max(row, 0), this->count());
+    count = std::min(std::max(count, 0), this->count() - row);
+    if (count == 0 && segments.isEmpty()) {
+        return;
+    }
+
+    // The replaced rows' words are contiguous in the timeline
+    const int firstWord = row < this->count() ? m_rows[row].firstWord : m_words.count();
+    int oldWords = 0;
+    for (int i = row; i < row + count; ++i) {
+        oldWords += m_rows[i].wordCount;
+    }
+    QVector<TranscriptWord> words;
+    for (const TranscriptSegment &segment : segments) {
+        words += segment.words;
+    }
+    m_words.replace(firstWord, oldWords, words);
+
+    std::vector<Row> rows;
+    rows.reserve(segments.size());
+    int nextWord = firstWord;
+    for (const TranscriptSegment &segment : segments) {
+        Row r;
+        r.segment = segment;
+        r.segment.words.clear();
+        r.segment.speakerVector.clear();
+        r.firstWord = nextWord;
+        r.wordCount = segment.words.size();
+        nextWord += r.wordCount;
+        rows.push_back(std::move(r));
+    }
+
+    const int common = std::min(count, static_cast<int>(rows.size()));
+    std::move(rows.begin(), rows.begin() + common, m_rows.begin() + row);
+    if (count > common) {
+        beginRemoveRows(QModelIndex(), row + common, row + count - 1);
+        m_rows.erase(m_rows.begin() + row + common, m_rows.begin() + row + count);
+        endRemoveRows();
+    } else if (static_cast<int>(rows.size()) > common) {
+        beginInsertRows(QModelIndex(), row + common, row + static_cast<int>(rows.size()) - 1);
+        m_rows.insert(m_rows.begin() + row + common,
+                      std::make_move_iterator(rows.begin() + common), std::make_move_iterator(rows.end()));
+        endInsertRows();
+    }
+
+    const int shift = words.size() - oldWords;
+    for (size_t i = row + rows.size(); shift != 0 && i < m_rows.size(); ++i) {
+        m_rows[i].firstWord += shift;
+    }
+    // Word ranges move for every later row as well
+    const int lastChanged = shift != 0 ? this->count() - 1 : row + common - 1;
+    if (row <= lastChanged) {
+        emit dataChanged(index(row), index(lastChanged));
+    }
+    if (count != static_cast<int>(rows.size()) || shift != 0) {
+        emit countChanged();
+    }
+}
+
+void TranscriptModel::clear()
+{
+    if (m_rows.empty() && m_evictedCount == 0) {
+        return;
+    }
+    beginResetModel();
+    m_rows.clear();
+    m_words.clear();
+    m_evictedCount = 0;
+    endResetModel();
+    emit countChanged();
+}
+
+void TranscriptModel::setMaxRows(int rows)
+{
+    m_maxRows = std::max(0, rows);
+    if (m_maxRows > 0 && count() > m_maxRows) {
+        evict(count() - m_maxRows);
+    }
+}
+
+void TranscriptModel::evict(int rows)
+{
+    rows = std::min(rows, count());
+    if (rows <= 0) {
+        return;
+    }
+
+    const int words = rows < count() ? m_rows[rows].firstWord : m_words.count();
+    beginRemoveRows(QModelIndex(), 0, rows - 1);
+    m_rows.erase(m_rows.begin(), m_rows.begin() + rows);
+    m_words.removeFront(words);
+    for (Row &row : m_rows) {
+        row.firstWord -= words;
+    }
+    m_evictedCount += rows;
+    endRemoveRows();
+    emit countChanged();
+}
+
+QString TranscriptModel::text() const
+{
+    int length = 0;
+    for (const Row &row : m_rows) {
+        length += row.segment.text.size() + 1;
+    }
+
+    QString text;
+    text.reserve(length);
+    for (const Row &row : m_rows) {
+        if (!text.isEmpty()) {
+            text += ' ';
+        }
+        text += row.segment.text;
+    }
+    return text;
+}
+
+QVariantList TranscriptModel::words(int row) const
+{
+    QVariantList list;
+    if (row < 0 || row >= count()) {
+        return list;
+    }
+
+    const Row &r = m_rows[row];
+    list.reserve(r.wordCount);
+    for (int i = r.firstWord; i < r.firstWord + r.wordCount; ++i) {
+        list.append(word(i));
+    }
+    return list;
+}
+
+QVariantMap TranscriptModel::word(int index) const
+{
+    if (index < 0 || index >= m_words.count()) {
+        return QVariantMap();
+    }
+    return {
+        { "index", index },
+        { "text", m_words.text(index) },
+        { "startTime", m_words.startMs(index) },
+        { "endTime", m_words.endMs(index) },
+        { "confidence", m_words.confidence(index) },
+    };
+}
+
+QVariantList TranscriptModel::alternatives(int row) const
+{
+    QVariantList list;
+    if (row < 0 || row >= count() || m_rows[row].segment.alternatives.isEmpty()) {
+        return list;
+    }
+
+    const QJsonArray array = QJsonDocument::fromJson(m_rows[row].segment.alternatives).array();
+    list.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        const QJsonObject alternative = value.toObject();
+        list.append(QVariantMap {
+            { "text", alternative.value("text").toString() },
+            { "confidence", alternative.value("confidence").toDouble() },
+        });
+    }
+    return list;
+}
+
+int TranscriptModel::segmentAt(qint64 timeMs) const
+{
+    // Rows are appended in time order
+    auto it = std::upper_bound(m_rows.begin(), m_rows.end(), timeMs, [](qint64 t, const Row &row) {
+        return t < row.segment.startMs;
+    });
+    if (it == m_rows.begin()) {
+        return -1;
+    }
+    --it;
+    return timeMs <= it->segment.endMs ? static_cast<int>(it - m_rows.begin()) : -1;
+}
+
+int TranscriptModel::wordAt(qint64 timeMs) const
+{
+    const int row = segmentAt(timeMs);
+    if (row < 0) {
+        return -1;
+    }
+    const Row &r = m_rows[row];
+    return m_words.find(r.firstWord, r.wordCount, timeMs);
+}
@@ -0,0 +1,105 @@
+#ifndef TRANSCRIPTMODEL_H
+#define TRANSCRIPTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <vector>
+
+#include "transcript_segment.h"
+#include "word_timeline.h"
+
+// The session transcript as a list of utterances. Appending inserts one
+// row, so a ListView only creates a delegate for the new segment instead
+// of re-laying out the whole text. Word timings live in a shared
+// WordTimeline; each row refers to a range of it.
+class TranscriptModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int wordCount READ wordCount NOTIFY countChanged)
+    Q_PROPERTY(int evictedCount READ evictedCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TextRole = Qt::UserRole + 1,
+        StartTimeRole,
+        EndTimeRole,
+        ConfidenceRole,
+        FirstWordRole,
+        WordCountRole,
+        SpeakerRole,
+        AlternativeCountRole
+    };
+
+    explicit TranscriptModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+    int wordCount() const { return m_words.count(); }
+
+    // Keeps at most |rows| segments (0: unlimited). Beyond that the oldest
+    // quarter is dropped at once, together with its words, so a
+    // multi-hour session stays at a flat size; whoever sets a limit is
+    // expected to have written the rows elsewhere (TranscriptSpill).
+    void setMaxRows(int rows);
+    int maxRows() const { return m_maxRows; }
+
+    // Segments dropped by the row limit since the last clear()
+    int evictedCount() const { return m_evictedCount; }
+
+    // Segment without its words (those are in timeline()) or speaker vector
+    const TranscriptSegment &segment(int row) const { return m_rows[row].segment; }
+    const WordTimeline &timeline() const { return m_words; }
+    int firstWord(int row) const { return m_rows[row].firstWord; }
+    int segmentWordCount(int row) const { return m_rows[row].wordCount; }
+
+    void append(const TranscriptSegment &segment);
+
+    // Replaces the rows [row, row + count) with |segments|, words included;
+    // count 0 inserts. Rows that stay in place are updated, not recreated,
+    // so views keep their delegates.
+    void replace(int row, int count, const QVector<TranscriptSegment> &segments);
+    void clear();
+
+    // Resident transcript joined with spaces; O(n), for export and copying
+    Q_INVOKABLE QString text() const;
+
+    // Words of one segment as {index, text, startTime, endTime, confidence}
+    Q_INVOKABLE QVariantList words(int row) const;
+    Q_INVOKABLE QVariantMap word(int index) const;
+
+    // N-best hypotheses of one segment as {text, confidence}, best first;
+    // parsed from the stored JSON on each call
+    Q_INVOKABLE QVariantList alternatives(int row) const;
+
+    // For seeking and highlighting during playback: the segment / word
+    // (timeline index) being spoken at timeMs, or -1
+    Q_INVOKABLE int segmentAt(qint64 timeMs) const;
+    Q_INVOKABLE int wordAt(qint64 timeMs) const;
+
+signals:
+    void countChanged();
+
+private:
+    struct Row
+    {
+        TranscriptSegment segment;
+        int firstWord = 0;
+        int wordCount = 0;
+    };
+
+    void evict(int rows);
+
+    std::vector<Row> m_rows;
+    WordTimeline m_words;
+    int m_maxRows = 0;
+    int m_evictedCount = 0;
+};
+
+#endif // TRANSCRIPTMODEL_H
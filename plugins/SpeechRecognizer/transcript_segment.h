@@ -0,0 +1,35 @@
+#ifndef TRANSCRIPTSEGMENT_H
+#define TRANSCRIPTSEGMENT_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// Times are milliseconds of session audio, i.e. since recording started,
+// silence included.
+struct TranscriptWord
+{
+    QString text;
+    qint64 startMs = 0;
+    qint64 endMs = 0;
+    float confidence = 1.0f; // 0..1
+};
+
+// One finalized utterance
+struct TranscriptSegment
+{
+    QString text;
+    qint64 startMs = 0;
+    qint64 endMs = 0;
+    float confidence = 1.0f; // mean word confidence, 0..1
+    QVector<TranscriptWord> words;
+    QString speaker;              // enrolled speaker name, empty if unknown
+    QVector<float> speakerVector; // x-vector, only with a speaker model
+    QByteArray alternatives;      // raw N-best JSON array, best first
+    int alternativeCount = 0;
+};
+
+Q_DECLARE_METATYPE(TranscriptSegment)
+
+#endif // TRANSCRIPTSEGMENT_H
@@ -0,0 +1,98 @@
+#include "transcript_spill.h"
+#include "transcript_model.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+bool TranscriptSpill::open(const QString &path)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void TranscriptSpill::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool TranscriptSpill::append(const TranscriptModel &model, int row)
+{
+    if (!m_file.isOpen() || row < 0 || row >= model.count()) {
+        return false;
+    }
+
+    // Rows keep their words in the model's timeline
+    TranscriptSegment segment = model.segment(row);
+    const WordTimeline &timeline = model.timeline();
+    const int first = model.firstWord(row);
+    segment.words.reserve(model.segmentWordCount(row));
+    for (int i = first; i < first + model.segmentWordCount(row); ++i) {
+        segment.words.append(TranscriptWord { timeline.text(i), timeline.startMs(i), timeline.endMs(i),
+                                              timeline.confidence(i) });
+    }
+
+    QByteArray line = encode(segment);
+    line += '\n';
+    return m_file.write(line) == line.size() && m_file.flush();
+}
+
+QByteArray TranscriptSpill::encode(const TranscriptSegment &segment)
+{
+    QJsonArray words;
+    for (const TranscriptWord &word : segment.words) {
+        words.append(QJsonObject {
+            { "word", word.text },
+            { "start", word.startMs },
+            { "end", word.endMs },
+            { "conf", word.confidence },
+        });
+    }
+
+    QJsonObject object {
+        { "start", segment.startMs },
+        { "end", segment.endMs },
+        { "text", segment.text },
+        { "confidence", segment.confidence },
+        { "words", words },
+    };
+    if (!segment.speaker.isEmpty()) {
+        object.insert("speaker", segment.speaker);
+    }
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+bool TranscriptSpill::decode(const QByteArray &line, TranscriptSegment *segment)
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        return false;
+    }
+
+    const QJsonObject object = document.object();
+    if (!object.contains("start") || !object.contains("end") || !object.contains("text")) {
+        return false;
+    }
+    TranscriptSegment result;
+    result.startMs = static_cast<qint64>(object.value("start").toDouble());
+    result.endMs = static_cast<qint64>(object.value("end").toDouble());
+    result.text = object.value("text").toString();
+    result.confidence = static_cast<float>(object.value("confidence").toDouble(1.0));
+    result.speaker = object.value("speaker").toString();
+    for (const QJsonValue &value : object.value("words").toArray()) {
+        const QJsonObject word = value.toObject();
+        result.words.append(TranscriptWord { word.value("word").toString(),
+                                             static_cast<qint64>(word.value("start").toDouble()),
+                                             static_cast<qint64>(word.value("end").toDouble()),
+                                             static_cast<float>(word.value("conf").toDouble(1.0)) });
+    }
+    *segment = result;
+    return true;
+}
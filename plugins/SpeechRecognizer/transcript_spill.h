@@ -0,0 +1,43 @@
+#ifndef TRANSCRIPTSPILL_H
+#define TRANSCRIPTSPILL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+class TranscriptModel;
+struct TranscriptSegment;
+
+// Append-only copy of a transcript on disk, one JSON object per segment
+// and line: {"start", "end", "text", "confidence", "speaker", "words":
+// [{"word", "start", "end", "conf"}]}, times in milliseconds. Lets the
+// in-memory TranscriptModel drop old rows during long sessions while the
+// full text stays available. Each line is flushed to the OS as written.
+class TranscriptSpill
+{
+public:
+    TranscriptSpill() = default;
+
+    // Appends to |path|, creating it and its directory if needed
+    bool open(const QString &path);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+    QString errorString() const { return m_file.errorString(); }
+
+    // Writes one row of |model|, words included
+    bool append(const TranscriptModel &model, int row);
+
+    // One line of the format, without the newline
+    static QByteArray encode(const TranscriptSegment &segment);
+
+    // Parses one line back; false if it is not a complete segment object
+    // (e.g. a line cut short by a crash)
+    static bool decode(const QByteArray &line, TranscriptSegment *segment);
+
+private:
+    QFile m_file;
+};
+
+#endif // TRANSCRIPTSPILL_H
@@ -0,0 +1,175 @@
+#include "voice_activity_detector.h"
+#include "simd_dot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+VoiceActivityDetector::VoiceActivityDetector(int sampleRate, int preRollMs)
+    : m_frameSamples(std::max(1, sampleRate / 100))
+    , m_frame(m_frameSamples)
+{
+    // Pre-roll is kept as a whole number of frames
+    int preRollFrames = std::max(1, preRollMs / 10);
+    m_preRoll.resize(static_cast<size_t>(preRollFrames) * m_frameSamples);
+    m_runs.reserve(8);
+
+    setEnergyThreshold(m_energyThresholdDb);
+    setHangoverMs(1000);
+}
+
+void VoiceActivityDetector::setEnergyThreshold(float dbfs)
+{
+    m_energyThresholdDb = dbfs;
+
+    // Compare sums of squares directly so classification needs no log()
+    double amplitude = 32768.0 * std::pow(10.0, dbfs / 20.0);
+    m_energyThreshold = amplitude * amplitude * m_frameSamples;
+}
+
+void VoiceActivityDetector::setHangoverMs(int ms)
+{
+    m_hangoverFrames = std::max(0, ms / 10);
+}
+
+void VoiceActivityDetector::reset()
+{
+    m_frameFill = 0;
+    m_preRollStart = 0;
+    m_preRollFill = 0;
+    m_active = false;
+    m_speechRun = 0;
+    m_silenceRun = 0;
+    m_inputSamples = 0;
+    m_runs.clear();
+}
+
+int VoiceActivityDetector::maxOutputSamples(int count) const
+{
+    return count + static_cast<int>(m_preRoll.size()) + m_frameSamples;
+}
+
+bool VoiceActivityDetector::isSilent(const int16_t *samples, int count) const
+{
+    for (int pos = 0; pos + m_frameSamples <= count; pos += m_frameSamples) {
+        if (classifyFrame(samples + pos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int VoiceActivityDetector::process(const int16_t *samples, int count, int16_t *out)
+{
+    int written = 0;
+    int pos = 0;
+    m_runs.clear();
+
+    auto feed = [this, out, &written](const int16_t *frame) {
+        const bool wasActive = m_active;
+        const int n = handleFrame(frame, out + written);
+        m_inputSamples += m_frameSamples;
+
+        // An onset flushes the pre-roll, which ends with this frame
+        if (!wasActive && m_active) {
+            m_runs.push_back(Run { written, m_inputSamples - n });
+        }
+        written += n;
+    };
+
+    // Complete a frame carried over from the previous call
+    if (m_frameFill > 0) {
+        int take = std::min(count, m_frameSamples - m_frameFill);
+        std::memcpy(m_frame.data() + m_frameFill, samples, take * sizeof(int16_t));
+        m_frameFill += take;
+        pos = take;
+
+        if (m_frameFill < m_frameSamples) {
+            return 0;
+        }
+        feed(m_frame.data());
+        m_frameFill = 0;
+    }
+
+    for (; pos + m_frameSamples <= count; pos += m_frameSamples) {
+        feed(samples + pos);
+    }
+
+    // Keep the tail for the next call
+    m_frameFill = count - pos;
+    std::memcpy(m_frame.data(), samples + pos, m_frameFill * sizeof(int16_t));
+
+    return written;
+}
+
+bool VoiceActivityDetector::classifyFrame(const int16_t *frame) const
+{
+    const int64_t energy = simdSumSquares(frame, m_frameSamples);
+    const int crossings = simdSignChanges(frame, m_frameSamples);
+
+    if (energy >= m_energyThreshold) {
+        return true;
+    }
+
+    // Quiet but noisy frames (s, f, sh...) within 6 dB of the threshold
+    return energy >= m_energyThreshold * 0.25
+        && crossings > m_zeroCrossingThreshold * m_frameSamples;
+}
+
+int VoiceActivityDetector::handleFrame(const int16_t *frame, int16_t *out)
+{
+    bool speech = classifyFrame(frame);
+
+    if (m_active) {
+        std::memcpy(out, frame, m_frameSamples * sizeof(int16_t));
+
+        if (speech) {
+            m_silenceRun = 0;
+        } else if (++m_silenceRun > m_hangoverFrames) {
+            m_active = false;
+            m_speechRun = 0;
+            m_silenceRun = 0;
+        }
+        return m_frameSamples;
+    }
+
+    pushPreRoll(frame);
+    m_speechRun = speech ? m_speechRun + 1 : 0;
+
+    if (m_speechRun >= ONSET_FRAMES) {
+        m_active = true;
+        m_silenceRun = 0;
+        return flushPreRoll(out);
+    }
+    return 0;
+}
+
+void VoiceActivityDetector::pushPreRoll(const int16_t *frame)
+{
+    const int capacity = static_cast<int>(m_preRoll.size());
+
+    if (m_preRollFill == capacity) {
+        // Full: overwrite the oldest frame
+        std::memcpy(m_preRoll.data() + m_preRollStart, frame, m_frameSamples * sizeof(int16_t));
+        m_preRollStart = (m_preRollStart + m_frameSamples) % capacity;
+        return;
+    }
+
+    int end = (m_preRollStart + m_preRollFill) % capacity;
+    std::memcpy(m_preRoll.data() + end, frame, m_frameSamples * sizeof(int16_t));
+    m_preRollFill += m_frameSamples;
+}
+
+int VoiceActivityDetector::flushPreRoll(int16_t *out)
+{
+    const int capacity = static_cast<int>(m_preRoll.size());
+    const int first = std::min(m_preRollFill, capacity - m_preRollStart);
+
+    std::memcpy(out, m_preRoll.data() + m_preRollStart, first * sizeof(int16_t));
+    std::memcpy(out + first, m_preRoll.data(), (m_preRollFill - first) * sizeof(int16_t));
+
+    int written = m_preRollFill;
+    m_preRollStart = 0;
+    m_preRollFill = 0;
+    return written;
+}
@@ -0,0 +1,84 @@
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aligned_buffer.h"
+
+// Energy + zero-crossing voice activity detector placed in front of the
+// recognizer. Audio is classified in 10 ms frames; silent frames are held
+// back in a short pre-roll so word onsets are not clipped, and a hangover
+// keeps feeding trailing silence long enough for Vosk's endpoint rules
+// (conf/model.conf) to close the utterance: 1.0 s by default, set from the
+// model's longest rule with setHangoverMs().
+class VoiceActivityDetector
+{
+public:
+    // A stretch of output that is contiguous in the input: it starts at
+    // outputOffset in the last process() call's output and at inputPosition
+    // samples since reset(). Output between runs continues the previous run.
+    struct Run
+    {
+        int outputOffset;
+        int64_t inputPosition;
+    };
+
+    explicit VoiceActivityDetector(int sampleRate, int preRollMs = 300);
+
+    void setEnergyThreshold(float dbfs);
+    float energyThreshold() const { return m_energyThresholdDb; }
+
+    // Zero crossings per sample above which quiet frames count as unvoiced speech
+    void setZeroCrossingThreshold(float rate) { m_zeroCrossingThreshold = rate; }
+    float zeroCrossingThreshold() const { return m_zeroCrossingThreshold; }
+
+    void setHangoverMs(int ms);
+
+    void reset();
+
+    // Writes the samples that should reach the decoder to |out| and returns
+    // how many were written. |out| must hold maxOutputSamples(count).
+    int process(const int16_t *samples, int count, int16_t *out);
+    int maxOutputSamples(int count) const;
+
+    // Runs that started during the last process() call (speech onsets)
+    const std::vector<Run> &runs() const { return m_runs; }
+
+    bool isSpeechActive() const { return m_active; }
+
+    // True if no whole 10 ms frame of |samples| would be classified as
+    // speech. Stateless; used to pick what to drop when decoding falls behind.
+    bool isSilent(const int16_t *samples, int count) const;
+
+private:
+    bool classifyFrame(const int16_t *frame) const;
+    int handleFrame(const int16_t *frame, int16_t *out);
+    void pushPreRoll(const int16_t *frame);
+    int flushPreRoll(int16_t *out);
+
+    int m_frameSamples;
+    float m_energyThresholdDb = -45.0f;
+    double m_energyThreshold = 0.0; // sum of squares per frame
+    float m_zeroCrossingThreshold = 0.25f;
+    int m_hangoverFrames = 0;
+    static constexpr int ONSET_FRAMES = 2;
+
+    // Partial frame carried over between process() calls
+    AlignedBuffer<int16_t> m_frame;
+    int m_frameFill = 0;
+
+    // Circular pre-roll of recent silent frames
+    AlignedBuffer<int16_t> m_preRoll;
+    int m_preRollStart = 0;
+    int m_preRollFill = 0;
+
+    bool m_active = false;
+    int m_speechRun = 0;
+    int m_silenceRun = 0;
+
+    int64_t m_inputSamples = 0; // whole frames classified since reset()
+    std::vector<Run> m_runs;
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
@@ -0,0 +1,72 @@
+#include "vosk_grammar.h"
+#include "vosk_api.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+VoskGrammar VoskGrammar::fromPhrases(const QStringList &phrases)
+{
+    VoskGrammar grammar;
+    for (const QString &phrase : phrases) {
+        QString normalized = phrase.simplified().toLower();
+        if (!normalized.isEmpty() && !grammar.m_phrases.contains(normalized)) {
+            grammar.m_phrases.append(normalized);
+        }
+    }
+    return grammar;
+}
+
+VoskGrammar VoskGrammar::fromJson(const QString &json, QString *error)
+{
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isArray()) {
+        if (error) {
+            *error = parseError.error != QJsonParseError::NoError ? parseError.errorString()
+                                                                  : QString("Grammar must be a JSON array of phrases");
+        }
+        return VoskGrammar();
+    }
+
+    QStringList phrases;
+    for (const QJsonValue &value : document.array()) {
+        if (!value.isString()) {
+            if (error) {
+                *error = "Grammar must be a JSON array of phrases";
+            }
+            return VoskGrammar();
+        }
+        phrases.append(value.toString());
+    }
+    return fromPhrases(phrases);
+}
+
+std::string VoskGrammar::toJson() const
+{
+    if (m_phrases.isEmpty()) {
+        return std::string();
+    }
+    QByteArray json = QJsonDocument(QJsonArray::fromStringList(m_phrases)).toJson(QJsonDocument::Compact);
+    return std::string(json.constData(), static_cast<size_t>(json.size()));
+}
+
+QStringList VoskGrammar::unknownWords(VoskModel *model) const
+{
+    QStringList unknown;
+    if (!model) {
+        return unknown;
+    }
+
+    for (const QString &phrase : m_phrases) {
+        for (const QString &word : phrase.split(' ')) {
+            if (word == QLatin1String("[unk]") || unknown.contains(word)) {
+                continue;
+            }
+            if (vosk_model_find_word(model, word.toUtf8().constData()) < 0) {
+                unknown.append(word);
+            }
+        }
+    }
+    return unknown;
+}
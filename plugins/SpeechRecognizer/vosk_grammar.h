@@ -0,0 +1,40 @@
+#ifndef VOSKGRAMMAR_H
+#define VOSKGRAMMAR_H
+
+#include <QString>
+#include <QStringList>
+
+#include <string>
+
+struct VoskModel;
+
+// A phrase list for constrained recognition of voice commands. Phrases
+// are normalized (lower case, single spaces), so the same command set
+// always produces the same JSON and hits the same pooled recognizer.
+// The special word "[unk]" lets out-of-grammar speech decode as unknown
+// instead of being forced onto the closest command.
+class VoskGrammar
+{
+public:
+    VoskGrammar() = default;
+    static VoskGrammar fromPhrases(const QStringList &phrases);
+
+    // A JSON array of strings, as taken by vosk_recognizer_new_grm()
+    static VoskGrammar fromJson(const QString &json, QString *error = nullptr);
+
+    bool isEmpty() const { return m_phrases.isEmpty(); }
+    const QStringList &phrases() const { return m_phrases; }
+
+    // Compact UTF-8 JSON for vosk_recognizer_new_grm(); empty if no phrases
+    std::string toJson() const;
+
+    // Words the model's vocabulary does not contain, in first-seen order.
+    // Vosk silently drops those from the graph, so a command using one
+    // could never be recognized.
+    QStringList unknownWords(VoskModel *model) const;
+
+private:
+    QStringList m_phrases;
+};
+
+#endif // VOSKGRAMMAR_H
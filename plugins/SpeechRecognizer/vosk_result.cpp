@@ -0,0 +1,435 @@
+#include "vosk_result.h"
+
+#include <cstring>
+
+// Recursive-descent reader over a null-terminated JSON buffer. Numbers are
+// parsed by hand because strtod() follows the C locale, which Qt sets from
+// the environment (a German locale would expect "0,5").
+class VoskResultReader
+{
+public:
+    VoskResultReader(VoskResult &result, const char *json)
+        : m_result(result)
+        , m_p(json)
+    {
+    }
+
+    bool parseDocument()
+    {
+        skipSpace();
+        if (!parseTopObject()) {
+            return false;
+        }
+        skipSpace();
+        return *m_p == '\0';
+    }
+
+private:
+    enum class Key { Other, Text, Partial, Result, PartialResult, Word, Start, End, Conf, Spk, SpkFrames, Alternatives };
+
+    void skipSpace()
+    {
+        while (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t') {
+            ++m_p;
+        }
+    }
+
+    bool expect(char c)
+    {
+        skipSpace();
+        if (*m_p != c) {
+            return false;
+        }
+        ++m_p;
+        return true;
+    }
+
+    // Iterates "key": value pairs; onMember parses or skips each value
+    template<typename OnMember>
+    bool parseObject(OnMember onMember)
+    {
+        if (!expect('{')) {
+            return false;
+        }
+        skipSpace();
+        if (*m_p == '}') {
+            ++m_p;
+            return true;
+        }
+        for (;;) {
+            skipSpace();
+            Key key;
+            if (!parseKey(key) || !expect(':')) {
+                return false;
+            }
+            skipSpace();
+            if (!onMember(key)) {
+                return false;
+            }
+            skipSpace();
+            if (*m_p == ',') {
+                ++m_p;
+                continue;
+            }
+            return expect('}');
+        }
+    }
+
+    template<typename OnElement>
+    bool parseArray(OnElement onElement)
+    {
+        if (!expect('[')) {
+            return false;
+        }
+        skipSpace();
+        if (*m_p == ']') {
+            ++m_p;
+            return true;
+        }
+        for (;;) {
+            skipSpace();
+            if (!onElement()) {
+                return false;
+            }
+            skipSpace();
+            if (*m_p == ',') {
+                ++m_p;
+                continue;
+            }
+            return expect(']');
+        }
+    }
+
+    bool parseTopObject()
+    {
+        return parseObject([this](Key key) {
+            switch (key) {
+            case Key::Partial:
+                m_result.m_partial = true;
+                // fall through
+            case Key::Text:
+                return parseString(m_result.m_text, m_result.m_textLength, true);
+            case Key::Result:
+            case Key::PartialResult:
+                return parseArray([this]() { return parseWord(); });
+            case Key::Spk:
+                return parseArray([this]() {
+                    float value;
+                    if (!parseNumber(value)) {
+                        return false;
+                    }
+                    m_result.m_speakerVector.push_back(value);
+                    return true;
+                });
+            case Key::Alternatives: {
+                // Only the best hypothesis is read; the list is kept raw
+                // for whoever wants it later
+                const char *begin = m_p;
+                int index = 0;
+                bool ok = parseArray([this, &index]() {
+                    return index++ == 0 ? parseTopObject() : skipValue();
+                });
+                m_result.m_alternatives = begin;
+                m_result.m_alternativesLength = static_cast<int>(m_p - begin);
+                m_result.m_alternativeCount = index;
+                return ok;
+            }
+            case Key::SpkFrames: {
+                float frames;
+                if (!parseNumber(frames)) {
+                    return false;
+                }
+                m_result.m_speakerFrames = static_cast<int>(frames);
+                return true;
+            }
+            default:
+                return skipValue();
+            }
+        });
+    }
+
+    bool parseWord()
+    {
+        VoskWord word;
+        bool ok = parseObject([this, &word](Key key) {
+            switch (key) {
+            case Key::Word:
+                return parseString(word.text, word.length, false);
+            case Key::Start:
+                return parseNumber(word.start);
+            case Key::End:
+                return parseNumber(word.end);
+            case Key::Conf:
+                return parseNumber(word.conf);
+            default:
+                return skipValue();
+            }
+        });
+        if (ok) {
+            m_result.m_words.push_back(word);
+        }
+        return ok;
+    }
+
+    bool parseKey(Key &key)
+    {
+        if (*m_p != '"') {
+            return false;
+        }
+        const char *begin = ++m_p;
+        while (*m_p != '"') {
+            if (*m_p == '\0') {
+                return false;
+            }
+            if (*m_p == '\\' && m_p[1] != '\0') {
+                ++m_p;
+            }
+            ++m_p;
+        }
+        const size_t length = static_cast<size_t>(m_p - begin);
+        ++m_p;
+
+        auto is = [begin, length](const char *name) {
+            return std::strlen(name) == length && std::memcmp(begin, name, length) == 0;
+        };
+        if (is("text")) key = Key::Text;
+        else if (is("partial")) key = Key::Partial;
+        else if (is("result")) key = Key::Result;
+        else if (is("partial_result")) key = Key::PartialResult;
+        else if (is("word")) key = Key::Word;
+        else if (is("start")) key = Key::Start;
+        else if (is("end")) key = Key::End;
+        else if (is("conf")) key = Key::Conf;
+        else if (is("spk")) key = Key::Spk;
+        else if (is("spk_frames")) key = Key::SpkFrames;
+        else if (is("alternatives")) key = Key::Alternatives;
+        else key = Key::Other;
+        return true;
+    }
+
+    // Unescapes into the result's string buffer, which was sized up front
+    // (output never exceeds input), so earlier views stay valid
+    bool parseString(const char *&text, int &length, bool trim)
+    {
+        if (*m_p != '"') {
+            return false;
+        }
+        ++m_p;
+
+        char *out = m_result.m_strings.data() + m_stringsUsed;
+        char *begin = out;
+        for (;;) {
+            char c = *m_p++;
+            if (c == '"') {
+                break;
+            }
+            if (c == '\0') {
+                return false;
+            }
+            if (c != '\\') {
+                *out++ = c;
+                continue;
+            }
+            switch (c = *m_p++) {
+            case 'n': *out++ = '\n'; break;
+            case 't': *out++ = '\t'; break;
+            case 'r': *out++ = '\r'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'u':
+                if (!parseUnicodeEscape(out)) {
+                    return false;
+                }
+                break;
+            case '\0':
+                return false;
+            default:
+                *out++ = c; // \" \\ \/
+                break;
+            }
+        }
+
+        m_stringsUsed += static_cast<size_t>(out - begin);
+        if (trim) {
+            while (begin < out && static_cast<unsigned char>(*begin) <= ' ') {
+                ++begin;
+            }
+            while (out > begin && static_cast<unsigned char>(out[-1]) <= ' ') {
+                --out;
+            }
+        }
+        text = begin;
+        length = static_cast<int>(out - begin);
+        return true;
+    }
+
+    bool parseHex4(unsigned &value)
+    {
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = *m_p++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    // \uXXXX (6 input bytes) encodes to at most 3 UTF-8 bytes, a surrogate
+    // pair (12 input bytes) to 4, so the output still fits
+    bool parseUnicodeEscape(char *&out)
+    {
+        unsigned code;
+        if (!parseHex4(code)) {
+            return false;
+        }
+        if (code >= 0xD800 && code <= 0xDBFF && m_p[0] == '\\' && m_p[1] == 'u') {
+            m_p += 2;
+            unsigned low;
+            if (!parseHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                return false;
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code);
+        } else if (code < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (code >> 18));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        }
+        return true;
+    }
+
+    bool parseNumber(float &value)
+    {
+        bool negative = false;
+        if (*m_p == '-') {
+            negative = true;
+            ++m_p;
+        }
+        if (*m_p < '0' || *m_p > '9') {
+            return false;
+        }
+
+        double mantissa = 0.0;
+        while (*m_p >= '0' && *m_p <= '9') {
+            mantissa = mantissa * 10.0 + (*m_p++ - '0');
+        }
+        if (*m_p == '.') {
+            ++m_p;
+            double scale = 0.1;
+            while (*m_p >= '0' && *m_p <= '9') {
+                mantissa += (*m_p++ - '0') * scale;
+                scale *= 0.1;
+            }
+        }
+        if (*m_p == 'e' || *m_p == 'E') {
+            ++m_p;
+            bool negativeExponent = false;
+            if (*m_p == '+' || *m_p == '-') {
+                negativeExponent = *m_p++ == '-';
+            }
+            int exponent = 0;
+            while (*m_p >= '0' && *m_p <= '9') {
+                exponent = exponent * 10 + (*m_p++ - '0');
+            }
+            double factor = 1.0;
+            while (exponent-- > 0) {
+                factor *= 10.0;
+            }
+            mantissa = negativeExponent ? mantissa / factor : mantissa * factor;
+        }
+
+        value = static_cast<float>(negative ? -mantissa : mantissa);
+        return true;
+    }
+
+    bool skipLiteral(const char *literal)
+    {
+        const size_t length = std::strlen(literal);
+        if (std::strncmp(m_p, literal, length) != 0) {
+            return false;
+        }
+        m_p += length;
+        return true;
+    }
+
+    bool skipValue()
+    {
+        switch (*m_p) {
+        case '{':
+            return parseObject([this](Key) { return skipValue(); });
+        case '[':
+            return parseArray([this]() { return skipValue(); });
+        case '"': {
+            ++m_p;
+            while (*m_p != '"') {
+                if (*m_p == '\0') {
+                    return false;
+                }
+                if (*m_p == '\\' && m_p[1] != '\0') {
+                    ++m_p;
+                }
+                ++m_p;
+            }
+            ++m_p;
+            return true;
+        }
+        case 't':
+            return skipLiteral("true");
+        case 'f':
+            return skipLiteral("false");
+        case 'n':
+            return skipLiteral("null");
+        default: {
+            float ignored;
+            return parseNumber(ignored);
+        }
+        }
+    }
+
+    VoskResult &m_result;
+    const char *m_p;
+    size_t m_stringsUsed = 0;
+};
+
+bool VoskResult::parse(const char *json)
+{
+    clear();
+    if (!json) {
+        return false;
+    }
+
+    const size_t length = std::strlen(json);
+    if (m_strings.size() < length) {
+        m_strings.resize(length);
+    }
+
+    VoskResultReader reader(*this, json);
+    return reader.parseDocument();
+}
+
+void VoskResult::clear()
+{
+    m_partial = false;
+    m_text = "";
+    m_textLength = 0;
+    m_words.clear();
+    m_speakerVector.clear();
+    m_speakerFrames = 0;
+    m_alternatives = nullptr;
+    m_alternativesLength = 0;
+    m_alternativeCount = 0;
+}
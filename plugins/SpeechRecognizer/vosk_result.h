@@ -0,0 +1,79 @@
+#ifndef VOSKRESULT_H
+#define VOSKRESULT_H
+
+#include <QString>
+
+#include <cstddef>
+#include <vector>
+
+struct VoskWord
+{
+    const char *text = ""; // UTF-8, not null-terminated
+    int length = 0;
+    float start = 0.0f;    // seconds of audio fed to the recognizer
+    float end = 0.0f;
+    float conf = 1.0f;
+};
+
+// Reads the JSON Vosk returns from vosk_recognizer_result(), partial_result()
+// and final_result() without building a DOM. Strings are unescaped into a
+// buffer owned by this object and exposed as views, valid until the next
+// parse(). Buffers keep their capacity, so once warmed up parsing performs
+// no heap allocations; reuse one instance per decoding thread.
+//
+// Extracted fields: "text" / "partial", "result" / "partial_result" word
+// arrays with "word", "start", "end" and "conf", and the speaker vector
+// "spk" / "spk_frames" of final results when a speaker model is attached.
+// With max alternatives set, text and words come from the best entry of
+// "alternatives" and the whole list is only delimited, not parsed.
+// Anything else is skipped.
+class VoskResult
+{
+public:
+    VoskResult() = default;
+
+    // False on malformed input; fields parsed up to the error are kept
+    bool parse(const char *json);
+
+    bool isPartial() const { return m_partial; }
+
+    // Text with surrounding whitespace removed
+    const char *text() const { return m_text; }
+    int textLength() const { return m_textLength; }
+    bool isEmpty() const { return m_textLength == 0; }
+
+    // Allocates; call only once the text is known to be needed
+    QString textString() const { return QString::fromUtf8(m_text, m_textLength); }
+
+    const std::vector<VoskWord> &words() const { return m_words; }
+
+    // X-vector of the utterance's speaker and how many frames it was
+    // computed from; empty without a speaker model
+    const std::vector<float> &speakerVector() const { return m_speakerVector; }
+    int speakerFrames() const { return m_speakerFrames; }
+
+    // The raw "alternatives" JSON array (N-best list, best first). Points
+    // into the parsed input, not into this object: copy it before the
+    // recognizer produces its next result.
+    const char *alternatives() const { return m_alternatives; }
+    int alternativesLength() const { return m_alternativesLength; }
+    int alternativeCount() const { return m_alternativeCount; }
+
+private:
+    friend class VoskResultReader;
+
+    void clear();
+
+    bool m_partial = false;
+    const char *m_text = "";
+    int m_textLength = 0;
+    std::vector<VoskWord> m_words;
+    std::vector<float> m_speakerVector;
+    int m_speakerFrames = 0;
+    const char *m_alternatives = nullptr;
+    int m_alternativesLength = 0;
+    int m_alternativeCount = 0;
+    std::vector<char> m_strings;
+};
+
+#endif // VOSKRESULT_H
@@ -0,0 +1,117 @@
+#include "word_timeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+int WordTimeline::append(const QString &text, qint64 startMs, qint64 endMs, float confidence)
+{
+    m_wordIds.push_back(intern(text));
+    m_startMs.push_back(static_cast<uint32_t>(std::max<qint64>(0, startMs)));
+    m_endMs.push_back(static_cast<uint32_t>(std::max<qint64>(0, endMs)));
+    m_confidence.push_back(quantize(confidence));
+    return count() - 1;
+}
+
+uint32_t WordTimeline::intern(const QString &text)
+{
+    auto it = m_ids.constFind(text);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    const uint32_t id = static_cast<uint32_t>(m_strings.size());
+    m_strings.push_back(text);
+    m_ids.insert(text, id);
+    return id;
+}
+
+uint8_t WordTimeline::quantize(float confidence)
+{
+    return static_cast<uint8_t>(std::lround(std::min(std::max(confidence, 0.0f), 1.0f) * 255.0f));
+}
+
+void WordTimeline::clear()
+{
+    m_wordIds.clear();
+    m_startMs.clear();
+    m_endMs.clear();
+    m_confidence.clear();
+    m_strings.clear();
+    m_ids.clear();
+}
+
+void WordTimeline::removeFront(int count)
+{
+    count = std::min(std::max(count, 0), this->count());
+    m_wordIds.erase(m_wordIds.begin(), m_wordIds.begin() + count);
+    m_startMs.erase(m_startMs.begin(), m_startMs.begin() + count);
+    m_endMs.erase(m_endMs.begin(), m_endMs.begin() + count);
+    m_confidence.erase(m_confidence.begin(), m_confidence.begin() + count);
+}
+
+void WordTimeline::replace(int first, int count, const QVector<TranscriptWord> &words)
+{
+    first = std::min(std::max(first, 0), this->count());
+    count = std::min(std::max(count, 0), this->count() - first);
+
+    // Overwrite in place as far as possible, then erase or insert the rest,
+    // so each column moves its tail at most once
+    const int common = std::min(count, words.size());
+    for (int i = 0; i < common; ++i) {
+        const TranscriptWord &word = words[i];
+        m_wordIds[first + i] = intern(word.text);
+        m_startMs[first + i] = static_cast<uint32_t>(std::max<qint64>(0, word.startMs));
+        m_endMs[first + i] = static_cast<uint32_t>(std::max<qint64>(0, word.endMs));
+        m_confidence[first + i] = quantize(word.confidence);
+    }
+
+    const int at = first + common;
+    if (count > common) {
+        const int excess = count - common;
+        m_wordIds.erase(m_wordIds.begin() + at, m_wordIds.begin() + at + excess);
+        m_startMs.erase(m_startMs.begin() + at, m_startMs.begin() + at + excess);
+        m_endMs.erase(m_endMs.begin() + at, m_endMs.begin() + at + excess);
+        m_confidence.erase(m_confidence.begin() + at, m_confidence.begin() + at + excess);
+    } else if (words.size() > common) {
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> starts;
+        std::vector<uint32_t> ends;
+        std::vector<uint8_t> confidences;
+        for (int i = common; i < words.size(); ++i) {
+            const TranscriptWord &word = words[i];
+            ids.push_back(intern(word.text));
+            starts.push_back(static_cast<uint32_t>(std::max<qint64>(0, word.startMs)));
+            ends.push_back(static_cast<uint32_t>(std::max<qint64>(0, word.endMs)));
+            confidences.push_back(quantize(word.confidence));
+        }
+        m_wordIds.insert(m_wordIds.begin() + at, ids.begin(), ids.end());
+        m_startMs.insert(m_startMs.begin() + at, starts.begin(), starts.end());
+        m_endMs.insert(m_endMs.begin() + at, ends.begin(), ends.end());
+        m_confidence.insert(m_confidence.begin() + at, confidences.begin(), confidences.end());
+    }
+}
+
+size_t WordTimeline::memoryBytes() const
+{
+    size_t bytes = m_wordIds.capacity() * sizeof(uint32_t)
+                 + m_startMs.capacity() * sizeof(uint32_t)
+                 + m_endMs.capacity() * sizeof(uint32_t)
+                 + m_confidence.capacity();
+    for (const QString &string : m_strings) {
+        bytes += sizeof(QString) + string.capacity() * sizeof(QChar);
+    }
+    return bytes;
+}
+
+int WordTimeline::find(int first, int count, qint64 timeMs) const
+{
+    if (count <= 0 || timeMs < 0) {
+        return -1;
+    }
+
+    auto begin = m_startMs.begin() + first;
+    auto it = std::upper_bound(begin, begin + count, static_cast<uint32_t>(timeMs));
+    if (it == begin) {
+        return -1;
+    }
+    return static_cast<int>(it - m_startMs.begin()) - 1;
+}
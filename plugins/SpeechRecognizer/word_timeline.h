@@ -0,0 +1,62 @@
+#ifndef WORDTIMELINE_H
+#define WORDTIMELINE_H
+
+#include <QHash>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "transcript_segment.h"
+
+// Word timings for a whole transcript, stored column-wise: a word id into
+// a table of interned strings, start/end in milliseconds and a confidence
+// quantized to a byte, 13 bytes per word. An hour of speech (~9000 words)
+// with a vocabulary of a few thousand distinct words stays well under 1 MB.
+class WordTimeline
+{
+public:
+    WordTimeline() = default;
+
+    // Returns the index of the new word
+    int append(const QString &text, qint64 startMs, qint64 endMs, float confidence);
+    void clear();
+
+    // Drops the oldest |count| words; later indexes shift down by |count|.
+    // Interned strings stay, so memory is bounded by the vocabulary rather
+    // than by how long the session runs.
+    void removeFront(int count);
+
+    // Replaces the words [first, first + count) with |words|; later indexes
+    // shift by words.size() - count
+    void replace(int first, int count, const QVector<TranscriptWord> &words);
+
+    int count() const { return static_cast<int>(m_wordIds.size()); }
+    int distinctWords() const { return static_cast<int>(m_strings.size()); }
+    size_t memoryBytes() const;
+
+    // Shares the interned string; no copy of the characters
+    QString text(int index) const { return m_strings[m_wordIds[index]]; }
+    qint64 startMs(int index) const { return m_startMs[index]; }
+    qint64 endMs(int index) const { return m_endMs[index]; }
+    float confidence(int index) const { return m_confidence[index] / 255.0f; }
+
+    // Word being spoken at timeMs among [first, first + count), which must
+    // be in time order: the last one starting at or before timeMs, or -1
+    int find(int first, int count, qint64 timeMs) const;
+
+private:
+    uint32_t intern(const QString &text);
+    static uint8_t quantize(float confidence);
+
+    std::vector<uint32_t> m_wordIds;
+    std::vector<uint32_t> m_startMs;
+    std::vector<uint32_t> m_endMs;
+    std::vector<uint8_t> m_confidence;
+
+    std::vector<QString> m_strings;
+    QHash<QString, uint32_t> m_ids;
+};
+
+#endif // WORDTIMELINE_H
@@ -46,10 +46,7 @@ MainView {
                 Action {
                     iconName: "delete"
                     text: i18n.tr("Clear")
-                    onTriggered: {
-                        SpeechRecognizer.clearTranscription()
-                        partialText.text = ""
-                    }
+                    onTriggered: SpeechRecognizer.clearTranscription()
                 }
             ]
         }
@@ -79,7 +76,7 @@ MainView {
                 Layout.preferredHeight: units.gu(5)
                 color: "#FF6584"
                 radius: units.gu(1)
-                visible: !SpeechRecognizer.isModelLoaded
+                visible: !SpeechRecognizer.isModelLoaded && !SpeechRecognizer.modelLoading
 
                 Label {
                     anchors.centerIn: parent
@@ -98,52 +95,87 @@ MainView {
                 border.color: primaryColor
                 border.width: 1
 
-                Flickable {
-                    id: transcriptionFlickable
+                // Only visible segments get delegates, so long sessions stay
+                // cheap; a new utterance adds a single row
+                ListView {
+                    id: transcriptionList
                     anchors {
                         fill: parent
                         margins: units.gu(2)
                     }
-                    contentHeight: transcriptionColumn.height
                     clip: true
+                    spacing: units.gu(1)
+                    model: SpeechRecognizer.transcript
 
-                    ColumnLayout {
-                        id: transcriptionColumn
-                        width: parent.width
-                        spacing: units.gu(1)
-
-                        // Final transcription
-                        Label {
-                            id: transcriptionText
-                            Layout.fillWidth: true
-                            text: SpeechRecognizer.transcription || i18n.tr("Tap the microphone and start speaking...")
-                            color: SpeechRecognizer.transcription ? textColor : textSecondaryColor
-                            font.pixelSize: units.gu(2)
-                            wrapMode: Text.WordWrap
-                            font.italic: !SpeechRecognizer.transcription
-                        }
+                    delegate: Label {
+                        width: transcriptionList.width
+                        text: model.speaker ? model.speaker + ": " + model.text : model.text
+                        color: textColor
+                        opacity: model.confidence < 0.6 ? 0.7 : 1.0
+                        font.pixelSize: units.gu(2)
+                        wrapMode: Text.WordWrap
+                    }
 
-                        // Partial result (live)
-                        Label {
-                            id: partialText
-                            Layout.fillWidth: true
-                            visible: text.length > 0
-                            color: primaryColor
-                            font.pixelSize: units.gu(1.8)
-                            font.italic: true
-                            wrapMode: Text.WordWrap
-                            opacity: 0.8
+                    // Partial result (live): words the recognizer has settled
+                    // on, then the tail it is still revising. Each label
+                    // only relayouts when its own part changes.
+                    footer: Item {
+                        width: transcriptionList.width
+                        height: partialFlow.visible ? partialFlow.height + units.gu(1) : 0
+
+                        Flow {
+                            id: partialFlow
+                            y: units.gu(1)
+                            width: parent.width
+                            visible: partialStableText.text.length > 0 || partialTailText.text.length > 0
+                            spacing: units.gu(0.6)
+
+                            Label {
+                                id: partialStableText
+                                width: Math.min(implicitWidth, partialFlow.width)
+                                visible: text.length > 0
+                                text: SpeechRecognizer.partialStable
+                                color: primaryColor
+                                font.pixelSize: units.gu(1.8)
+                                wrapMode: Text.WordWrap
+                                opacity: 0.8
+                            }
+
+                            Label {
+                                id: partialTailText
+                                width: Math.min(implicitWidth, partialFlow.width)
+                                visible: text.length > 0
+                                text: SpeechRecognizer.partialTail
+                                color: primaryColor
+                                font.pixelSize: units.gu(1.8)
+                                font.italic: true
+                                wrapMode: Text.WordWrap
+                                opacity: 0.6
+                            }
                         }
                     }
 
                     // Auto-scroll to bottom
                     onContentHeightChanged: {
                         if (contentHeight > height) {
-                            contentY = contentHeight - height
+                            positionViewAtEnd()
                         }
                     }
                 }
 
+                Label {
+                    anchors {
+                        fill: parent
+                        margins: units.gu(2)
+                    }
+                    visible: transcriptionList.count === 0 && !SpeechRecognizer.partialStable && !SpeechRecognizer.partialTail
+                    text: i18n.tr("Tap the microphone and start speaking...")
+                    color: textSecondaryColor
+                    font.pixelSize: units.gu(2)
+                    font.italic: true
+                    wrapMode: Text.WordWrap
+                }
+
                 // Scroll indicator
                 Rectangle {
                     anchors {
@@ -156,7 +188,7 @@ MainView {
                     radius: width / 2
                     color: primaryColor
                     opacity: 0.3
-                    visible: transcriptionFlickable.contentHeight > transcriptionFlickable.height
+                    visible: transcriptionList.contentHeight > transcriptionList.height
                 }
             }
 
@@ -190,7 +222,7 @@ MainView {
                     height: parent.height
                     radius: width / 2
                     color: "transparent"
-                    border.color: accentColor
+                    border.color: SpeechRecognizer.speechActive ? textColor : accentColor
                     border.width: units.gu(0.3)
                     opacity: 0
                     scale: 1
@@ -250,7 +282,7 @@ MainView {
 
                     MouseArea {
                         anchors.fill: parent
-                        enabled: SpeechRecognizer.isModelLoaded
+                        enabled: SpeechRecognizer.isModelLoaded || SpeechRecognizer.modelLoading
                         
                         onPressed: {
                             micButton.scale = 0.95
@@ -263,7 +295,6 @@ MainView {
                         onClicked: {
                             if (SpeechRecognizer.isRecording) {
                                 SpeechRecognizer.stopRecording()
-                                partialText.text = ""
                             } else {
                                 SpeechRecognizer.startRecording()
                             }
@@ -297,14 +328,6 @@ MainView {
     Connections {
         target: SpeechRecognizer
 
-        function onPartialResult(text) {
-            partialText.text = text
-        }
-
-        function onFinalResult(text) {
-            partialText.text = ""
-        }
-
         function onErrorOccurred(error) {
             console.log("Speech recognition error:", error)
         }